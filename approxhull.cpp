@@ -0,0 +1,154 @@
+#include "approxhull.h"
+#include <assert.h>
+#include <stdio.h>
+#include <math.h>
+
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+
+/* **************************************** */
+void approx_hull_init(approx_hull_stream* s, int xmin, int xmax, int k) {
+  assert(xmin <= xmax && k > 0);
+  s->xmin = xmin;
+  s->width = (long long)xmax - xmin + 1;
+  //more strips than x values would stay empty
+  if (k > s->width) k = s->width;
+  s->k = k;
+  s->lo.assign(k, point2d());
+  s->hi.assign(k, point2d());
+  s->x0.assign(k, 0);
+  s->x1.assign(k, 0);
+  s->used.assign(k, 0);
+  s->n = 0;
+}
+
+
+void approx_hull_add(approx_hull_stream* s, point2d p) {
+  long long dx = (long long)p.x - s->xmin;
+  if (dx < 0) dx = 0;
+  if (dx >= s->width) dx = s->width - 1;
+  int i = dx * s->k / s->width;
+
+  if (!s->used[i]) {
+    s->used[i] = 1;
+    s->lo[i] = s->hi[i] = p;
+    s->x0[i] = s->x1[i] = p.x;
+  } else {
+    if (p.y < s->lo[i].y) s->lo[i] = p;
+    if (p.y > s->hi[i].y) s->hi[i] = p;
+    if (p.x < s->x0[i]) s->x0[i] = p.x;
+    if (p.x > s->x1[i]) s->x1[i] = p.x;
+  }
+
+  if (s->n == 0) {
+    s->left_lo = s->left_hi = s->right_lo = s->right_hi = p;
+  } else {
+    if (p.x < s->left_lo.x) {
+      s->left_lo = s->left_hi = p;
+    } else if (p.x == s->left_lo.x) {
+      if (p.y < s->left_lo.y) s->left_lo = p;
+      if (p.y > s->left_hi.y) s->left_hi = p;
+    }
+    if (p.x > s->right_lo.x) {
+      s->right_lo = s->right_hi = p;
+    } else if (p.x == s->right_lo.x) {
+      if (p.y < s->right_lo.y) s->right_lo = p;
+      if (p.y > s->right_hi.y) s->right_hi = p;
+    }
+  }
+  s->n++;
+}
+
+
+/* **************************************** */
+/*
+  one monotone chain pass over p, which is sorted by x (copies of a
+  point may repeat): appends the chain, turning left, to out
+*/
+static void chain(const vector<point2d>& p, vector<point2d>& out) {
+  size_t base = out.size();
+  for (size_t i = 0; i < p.size(); i++) {
+    while (out.size() >= base + 2 && !left_strictly(out[out.size()-2], out.back(), p[i])) {
+      out.pop_back();
+    }
+    if (out.size() == base + 1 && out.back().x == p[i].x && out.back().y == p[i].y) continue;
+    out.push_back(p[i]);
+  }
+}
+
+double approx_hull_finish(approx_hull_stream* s, vector<point2d>& hull) {
+  hull.clear();
+  if (s->n == 0) return 0;
+
+  //the lower candidates left to right, from the leftmost lowest point
+  //to the rightmost highest one, and the upper ones back. a strip's
+  //points are all right of the previous strip's, so the candidates are
+  //in x order without sorting
+  vector<point2d> lower, upper;
+  lower.push_back(s->left_lo);
+  upper.push_back(s->right_hi);
+  double bound = 0;
+  for (int i = 0; i < s->k; i++) {
+    if (!s->used[i]) continue;
+    lower.push_back(s->lo[i]);
+    bound = max(bound, (double)(s->x1[i] - s->x0[i]));
+  }
+  for (int i = s->k - 1; i >= 0; i--) {
+    if (s->used[i]) upper.push_back(s->hi[i]);
+  }
+  lower.push_back(s->right_lo);
+  lower.push_back(s->right_hi);
+  upper.push_back(s->left_hi);
+  upper.push_back(s->left_lo);
+
+  //each chain ends where the other starts; keep the ends once
+  chain(lower, hull);
+  hull.pop_back();
+  chain(upper, hull);
+  hull.pop_back();
+  //all the points are copies of one point
+  if (hull.empty()) hull.push_back(s->left_lo);
+
+  //bottom point first, rightmost if tied
+  int b = 0;
+  for (int i = 1; i < (int)hull.size(); i++) {
+    if (hull[i].y < hull[b].y || (hull[i].y == hull[b].y && hull[i].x > hull[b].x)) b = i;
+  }
+  rotate(hull.begin(), hull.begin() + b, hull.end());
+  return bound;
+}
+
+
+/* **************************************** */
+double approx_hull(const vector<point2d>& pts, vector<point2d>& hull, int k) {
+  hull.clear();
+  if (pts.empty()) return 0;
+  if (k >= (int)pts.size()) {
+    hull = pts;
+    graham_scan_inplace(hull);
+    return 0;
+  }
+  int xmin, xmax;
+  x_range(pts.data(), pts.size(), &xmin, &xmax);
+  approx_hull_stream s;
+  approx_hull_init(&s, xmin, xmax, k);
+  for (size_t i = 0; i < pts.size(); i++) approx_hull_add(&s, pts[i]);
+  return approx_hull_finish(&s, hull);
+}
+
+double approx_hull_eps(const vector<point2d>& pts, vector<point2d>& hull, double eps) {
+  hull.clear();
+  if (pts.empty()) return 0;
+  int xmin, xmax;
+  x_range(pts.data(), pts.size(), &xmin, &xmax);
+  //a strip of w x values has extent at most w - 1, so strips of
+  //floor(eps) + 1 values are enough
+  long long width = (long long)xmax - xmin + 1;
+  long long w = eps < 0 ? 1 : (long long)floor(eps) + 1;
+  long long k = (width + w - 1) / w;
+  if (k >= (long long)pts.size()) k = pts.size();
+  return approx_hull(pts, hull, (int)k);
+}
@@ -0,0 +1,77 @@
+#ifndef __approxhull_h
+#define __approxhull_h
+
+#include "geom.h"
+
+#include <vector>
+
+using namespace std;
+
+
+/*
+  approximate hull in one pass, after Bentley, Faust and Preparata
+  (1982): the x range is cut into k vertical strips, and only the
+  lowest and the highest point of every strip are kept, plus the
+  leftmost and rightmost points. the hull of those (at most 2k + 4
+  points, already in x order) is found with a monotone chain pass, so
+  the whole thing is O(n + k) and needs O(k) memory, however many
+  points there are.
+
+  the result is an inner approximation: its vertices are input points,
+  and every input point outside it is within the bound returned, the
+  largest x extent of the points that fell in one strip (a point lies
+  between the lowest and highest point of its strip, so it is within
+  that extent of the segment joining them). with integer coordinates,
+  strips one x value wide make the hull exact and the bound 0.
+
+  the hull is in the same order as graham_scan(): CCW starting at the
+  bottom point (rightmost if tied), with no collinear vertices
+*/
+
+typedef struct _approx_hull_stream {
+  int xmin;          //left end of strip 0
+  long long width;   //xmax - xmin + 1: the x values the strips cover
+  int k;             //number of strips
+  //per strip: lowest and highest point, and the x extent of its points
+  vector<point2d> lo, hi;
+  vector<int> x0, x1;
+  vector<char> used;
+  //the leftmost and rightmost points, lowest and highest of each
+  point2d left_lo, left_hi, right_lo, right_hi;
+  long n;
+} approx_hull_stream;
+
+
+/*
+  starts a stream whose points have x in [xmin, xmax], cut into k
+  strips. points outside the range are put in the first or last strip,
+  which is still correct but makes the bound looser
+*/
+void approx_hull_init(approx_hull_stream* s, int xmin, int xmax, int k);
+
+/* adds one point, in O(1) */
+void approx_hull_add(approx_hull_stream* s, point2d p);
+
+/*
+  stores the hull of the points added so far in hull, and returns the
+  largest distance from an input point to it. the stream can take more
+  points afterwards
+*/
+double approx_hull_finish(approx_hull_stream* s, vector<point2d>& hull);
+
+
+/*
+  the hull of pts with k strips over their x range; returns the bound.
+  if k is not less than the number of points, the strips would not
+  save anything, and the exact hull is computed (bound 0)
+*/
+double approx_hull(const vector<point2d>& pts, vector<point2d>& hull, int k);
+
+/*
+  the same, with as few strips as guarantee that no point is farther
+  than eps from the hull
+*/
+double approx_hull_eps(const vector<point2d>& pts, vector<point2d>& hull, double eps);
+
+
+#endif
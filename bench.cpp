@@ -0,0 +1,549 @@
+/* bench.cpp
+
+   Microbenchmarks for the kernels in geom.cpp, and for the whole
+   in-place graham scan, with int and with double points (geomf.h).
+   Every kernel is run on a few controlled inputs (random, already
+   sorted, reverse sorted, all collinear, all on a circle) and reported
+   in ns per point.
+
+   Every measurement is warmed up, then sampled; samples outside
+   [Q1 - 1.5 IQR, Q3 + 1.5 IQR] are dropped and the rest averaged.
+
+   With -b, the results are compared against a baseline written earlier
+   with -w, and the program exits with 1 if any kernel got slower than
+   the baseline by more than the allowed slowdown (-s, default 20%).
+
+   Every kernel is also run once more with the hrtimer memory
+   accounting on (HRT_MEMORY), which gives its allocations and the peak
+   of its live heap per run. They go in the json file too, and a kernel
+   whose allocations or peak grew by more than the allowed slowdown
+   fails the comparison like a slower one.
+
+   usage: hullbench [-n npoints] [-k samples] [-w out.json] [-b baseline.json] [-s slowdown]
+*/
+
+#include "geom.h"
+#include "geomf.h"
+#include "approxhull.h"
+#include "hullarena.h"
+#include "hullpair.h"
+#include "hrtimer.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <vector>
+#include <string>
+#include <map>
+#include <algorithm>
+using namespace std;
+
+
+//window size used to generate the points, same as the viewer
+const int WINDOWSIZE = 500;
+
+//number of untimed runs before sampling
+const int WARMUP = 3;
+
+
+/* one benchmark result */
+typedef struct _bench_result {
+  string name;      //kernel/input
+  double ns_per_op;
+  int nsamples;     //samples kept after outlier rejection
+  long long allocs;      //allocations in one run
+  long long peak_bytes;  //the most it had allocated at once, in one run
+} bench_result;
+
+
+/* ****************************** */
+/* monotonic time in nanoseconds */
+static double now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+
+/* ****************************** */
+/* the mean of the samples that are not outliers (Tukey's fences) */
+static double robust_mean(vector<double>& samples, int* nkept) {
+  sort(samples.begin(), samples.end());
+  int k = samples.size();
+  double q1 = samples[k/4];
+  double q3 = samples[(3*k)/4];
+  double lo = q1 - 1.5*(q3 - q1);
+  double hi = q3 + 1.5*(q3 - q1);
+  double sum = 0;
+  *nkept = 0;
+  for (int i = 0; i < k; i++) {
+    if (samples[i] >= lo && samples[i] <= hi) {
+      sum += samples[i];
+      (*nkept)++;
+    }
+  }
+  return sum / *nkept;
+}
+
+
+/* ****************************** */
+/* point generators. all points are in [0, WINDOWSIZE] x [0, WINDOWSIZE] */
+
+void initialize_points_random(vector<point2d>& pts, int n) {
+  pts.clear();
+  point2d p;
+  for (int i = 0; i < n; i++) {
+    p.x = random() % WINDOWSIZE;
+    p.y = random() % WINDOWSIZE;
+    pts.push_back(p);
+  }
+}
+
+/* random points with the bottom point first and the rest radially
+   sorted around it, i.e. the input sort_points() produces */
+void initialize_points_sorted(vector<point2d>& pts, int n) {
+  initialize_points_random(pts, n);
+  int i0 = find_bottom_point(pts);
+  swap(pts[0], pts[i0]);
+  sort_points(pts);
+}
+
+/* like initialize_points_sorted(), but in reverse (clockwise) order after p0 */
+void initialize_points_reverse(vector<point2d>& pts, int n) {
+  initialize_points_sorted(pts, n);
+  reverse(pts.begin() + 1, pts.end());
+}
+
+/* random points on a diagonal line */
+void initialize_points_collinear(vector<point2d>& pts, int n) {
+  pts.clear();
+  point2d p;
+  for (int i = 0; i < n; i++) {
+    p.x = random() % WINDOWSIZE;
+    p.y = p.x;
+    pts.push_back(p);
+  }
+}
+
+/* points on a circle, in random order; every point is on the hull */
+void initialize_points_circle(vector<point2d>& pts, int n) {
+  pts.clear();
+  point2d p;
+  double radius = WINDOWSIZE / 2;
+  for (int i = 0; i < n; i++) {
+    double a = 2 * M_PI * (random() / (double)RAND_MAX);
+    p.x = (int)(WINDOWSIZE/2 + radius * cos(a));
+    p.y = (int)(WINDOWSIZE/2 + radius * sin(a));
+    pts.push_back(p);
+  }
+}
+
+
+/* ****************************** */
+/*
+  the kernels. each one is run on a fresh copy of the input, and
+  returns the number of operations it did; only the call itself is
+  timed. kernels that need sorted input get the input radially sorted
+  first (untimed). the timed region is also the "kernel" scope, which
+  the memory run of run_bench() reads, so the setup is not counted
+  there either.
+*/
+typedef long (*kernel_fn)(vector<point2d>& pts, double* elapsed);
+
+//keeps the compiler from dropping the results
+volatile long sink;
+
+long bench_orientation(vector<point2d>& pts, double* elapsed) {
+  long n = pts.size();
+  long count = 0;
+  {
+    HRT_SCOPE("kernel");
+    double t0 = now_ns();
+    for (long i = 0; i + 2 < n; i++) {
+      count += signed_area2D(pts[i], pts[i+1], pts[i+2]) > 0;
+      count += left_strictly(pts[i+2], pts[i], pts[i+1]);
+    }
+    *elapsed = now_ns() - t0;
+  }
+  sink = count;
+  return 2 * max(0L, n - 2);
+}
+
+long bench_find_bottom(vector<point2d>& pts, double* elapsed) {
+  {
+    HRT_SCOPE("kernel");
+    double t0 = now_ns();
+    sink = find_bottom_point(pts);
+    *elapsed = now_ns() - t0;
+  }
+  return pts.size();
+}
+
+/* moves the bottom point to the front, as graham_scan() does */
+static void put_bottom_first(vector<point2d>& pts) {
+  int i0 = find_bottom_point(pts);
+  swap(pts[0], pts[i0]);
+}
+
+long bench_merge(vector<point2d>& pts, double* elapsed) {
+  put_bottom_first(pts);
+  //sort each half, then time the final merge
+  int n = pts.size();
+  int mid = 1 + (n - 1) / 2;
+  sort_points(pts, 1, mid);
+  sort_points(pts, mid, n);
+  {
+    HRT_SCOPE("kernel");
+    double t0 = now_ns();
+    merge_points(pts, 1, mid, n);
+    *elapsed = now_ns() - t0;
+  }
+  return n - 1;
+}
+
+long bench_sort(vector<point2d>& pts, double* elapsed) {
+  put_bottom_first(pts);
+  {
+    HRT_SCOPE("kernel");
+    double t0 = now_ns();
+    sort_points(pts);
+    *elapsed = now_ns() - t0;
+  }
+  return pts.size();
+}
+
+long bench_build_hull(vector<point2d>& pts, double* elapsed) {
+  put_bottom_first(pts);
+  sort_points(pts);
+  vector<point2d> hull;
+  {
+    HRT_SCOPE("kernel");
+    double t0 = now_ns();
+    build_hull(pts, hull);
+    *elapsed = now_ns() - t0;
+  }
+  sink = hull.size();
+  return pts.size();
+}
+
+long bench_delete_middle(vector<point2d>& pts, double* elapsed) {
+  vector<point2d> kept;
+  {
+    HRT_SCOPE("kernel");
+    double t0 = now_ns();
+    kept = delete_middle_points(pts);
+    *elapsed = now_ns() - t0;
+  }
+  sink = kept.size();
+  return pts.size();
+}
+
+
+long bench_graham_inplace(vector<point2d>& pts, double* elapsed) {
+  {
+    HRT_SCOPE("kernel");
+    double t0 = now_ns();
+    sink = graham_scan_inplace(pts.data(), pts.size());
+    *elapsed = now_ns() - t0;
+  }
+  return pts.size();
+}
+
+
+/* the same points with double coordinates */
+static void to_double(const vector<point2d>& pts, vector<fpoint2d>& fpts) {
+  fpts.resize(pts.size());
+  for (size_t i = 0; i < pts.size(); i++) {
+    fpts[i].x = pts[i].x;
+    fpts[i].y = pts[i].y;
+  }
+}
+
+/* the kernels keep their buffers across runs (static), so that the
+   memory run sees only what the kernel itself allocates */
+long bench_orientation_double(vector<point2d>& pts, double* elapsed) {
+  static vector<fpoint2d> f;
+  to_double(pts, f);
+  long n = f.size();
+  long count = 0;
+  {
+    HRT_SCOPE("kernel");
+    double t0 = now_ns();
+    for (long i = 0; i + 2 < n; i++) {
+      count += orient2d(f[i], f[i+1], f[i+2]) > 0;
+      count += left_strictly(f[i+2], f[i], f[i+1]);
+    }
+    *elapsed = now_ns() - t0;
+  }
+  sink = count;
+  return 2 * max(0L, n - 2);
+}
+
+long bench_graham_inplace_double(vector<point2d>& pts, double* elapsed) {
+  static vector<fpoint2d> f;
+  to_double(pts, f);
+  {
+    HRT_SCOPE("kernel");
+    double t0 = now_ns();
+    sink = graham_scan_inplace(f.data(), f.size());
+    *elapsed = now_ns() - t0;
+  }
+  return pts.size();
+}
+
+
+/* one arena for all the runs: after the first one it has grown to
+   what the input needs, and the kernel allocates nothing */
+static hull_arena arena;
+
+long bench_graham_arena(vector<point2d>& pts, double* elapsed) {
+  static vector<point2d> hull;
+  {
+    HRT_SCOPE("kernel");
+    double t0 = now_ns();
+    hull_arena_reset(&arena);
+    graham_scan(pts, hull, &arena);
+    *elapsed = now_ns() - t0;
+  }
+  sink = hull.size();
+  return pts.size();
+}
+
+long bench_approx_hull(vector<point2d>& pts, double* elapsed) {
+  vector<point2d> hull;
+  {
+    HRT_SCOPE("kernel");
+    double t0 = now_ns();
+    approx_hull(pts, hull, 1000);
+    *elapsed = now_ns() - t0;
+  }
+  sink = hull.size();
+  return pts.size();
+}
+
+/* the input cut into hulls of SMALL_GROUP points, as in a clustering
+   job: graham_scan() takes its small_hull() path on every one */
+static const int SMALL_GROUP = 24;
+
+long bench_graham_small(vector<point2d>& pts, double* elapsed) {
+  static vector<point2d> group(SMALL_GROUP), hull(SMALL_GROUP);
+  long n = pts.size() / SMALL_GROUP * SMALL_GROUP;
+  long count = 0;
+  {
+    HRT_SCOPE("kernel");
+    double t0 = now_ns();
+    for (long i = 0; i < n; i += SMALL_GROUP) {
+      group.assign(pts.begin() + i, pts.begin() + i + SMALL_GROUP);
+      graham_scan(group, hull);
+      count += hull.size();
+    }
+    *elapsed = now_ns() - t0;
+  }
+  sink = count;
+  return n;
+}
+
+
+/* the two halves of the input as hulls (not timed), then their
+   Minkowski sum, intersection and overlap test, per hull vertex */
+long bench_hull_pair(vector<point2d>& pts, double* elapsed) {
+  static vector<point2d> a, b, sum;
+  static vector<fpoint2d> common;
+  size_t mid = pts.size() / 2;
+  a.assign(pts.begin(), pts.begin() + mid);
+  b.assign(pts.begin() + mid, pts.end());
+  graham_scan_inplace(a);
+  graham_scan_inplace(b);
+  long count;
+  {
+    HRT_SCOPE("kernel");
+    double t0 = now_ns();
+    hull_minkowski_sum(a, b, sum);
+    hull_intersection(a, b, common);
+    count = hull_overlap(a, b);
+    *elapsed = now_ns() - t0;
+  }
+  sink = count + sum.size() + common.size();
+  return a.size() + b.size();
+}
+
+
+/* ****************************** */
+/* times kernel on input and returns its ns per operation */
+bench_result run_bench(const char* kname, kernel_fn kernel,
+                       const char* iname, vector<point2d>& input, int nsamples) {
+  vector<double> samples;
+  vector<point2d> pts;
+  for (int i = 0; i < WARMUP + nsamples; i++) {
+    pts = input;
+    double elapsed;
+    long ops = kernel(pts, &elapsed);
+    if (i >= WARMUP) samples.push_back(elapsed / max(1L, ops));
+  }
+  bench_result r;
+  r.name = string(kname) + "/" + iname;
+  r.ns_per_op = robust_mean(samples, &r.nsamples);
+
+  //one more run, for the memory of the timed region (the "kernel" scope)
+  pts = input;
+  hrt_reset();
+  hrt_enable(1);
+  hrt_set_options(HRT_MEMORY);
+  double elapsed;
+  kernel(pts, &elapsed);
+  hrt_set_options(0);
+  hrt_enable(0);
+  hrt_node* m = hrt_find("kernel");
+  r.allocs = m->allocs;
+  r.peak_bytes = m->peak_bytes;
+  hrt_reset();
+  return r;
+}
+
+
+/* ****************************** */
+/* writes the results as a flat json object {"kernel/input": ns_per_op,
+   "kernel/input:allocs": allocs, "kernel/input:peak_bytes": bytes, ...} */
+int write_json(const char* path, vector<bench_result>& results) {
+  FILE* f = fopen(path, "w");
+  if (!f) {
+    perror(path);
+    return 0;
+  }
+  fprintf(f, "{\n");
+  for (int i = 0; i < (int)results.size(); i++) {
+    const char* name = results[i].name.c_str();
+    fprintf(f, "  \"%s\": %.4f,\n", name, results[i].ns_per_op);
+    fprintf(f, "  \"%s:allocs\": %lld,\n", name, results[i].allocs);
+    fprintf(f, "  \"%s:peak_bytes\": %lld%s\n", name, results[i].peak_bytes,
+            (i + 1 < (int)results.size()) ? "," : "");
+  }
+  fprintf(f, "}\n");
+  fclose(f);
+  return 1;
+}
+
+/* reads a json object written by write_json() into baseline */
+int read_json(const char* path, map<string, double>& baseline) {
+  FILE* f = fopen(path, "r");
+  if (!f) {
+    perror(path);
+    return 0;
+  }
+  char line[1024];
+  while (fgets(line, sizeof(line), f)) {
+    char* q1 = strchr(line, '"');
+    if (!q1) continue;
+    char* q2 = strchr(q1 + 1, '"');
+    char* colon = q2 ? strchr(q2, ':') : NULL;
+    if (!colon) continue;
+    baseline[string(q1 + 1, q2 - q1 - 1)] = atof(colon + 1);
+  }
+  fclose(f);
+  return 1;
+}
+
+
+/* ****************************** */
+int main(int argc, char** argv) {
+
+  int n = 100000;
+  int nsamples = 15;
+  const char* out_path = NULL;
+  const char* baseline_path = NULL;
+  double slowdown = 0.20;
+
+  int c;
+  while ((c = getopt(argc, argv, "n:k:w:b:s:")) != -1) {
+    switch (c) {
+    case 'n': n = atoi(optarg); break;
+    case 'k': nsamples = atoi(optarg); break;
+    case 'w': out_path = optarg; break;
+    case 'b': baseline_path = optarg; break;
+    case 's': slowdown = atof(optarg); break;
+    default:
+      printf("usage: %s [-n npoints] [-k samples] [-w out.json] [-b baseline.json] [-s slowdown]\n", argv[0]);
+      exit(1);
+    }
+  }
+  assert(n > 2 && nsamples > 0);
+  printf("hullbench: n=%d, %d samples per kernel\n\n", n, nsamples);
+  hull_arena_init(&arena, (size_t)2 * n * sizeof(point2d), HULL_ARENA_HUGEPAGES, 1);
+
+  const char* input_names[] = {"random", "sorted", "reverse", "collinear", "circle"};
+  void (*initializers[])(vector<point2d>&, int) = {
+    initialize_points_random, initialize_points_sorted, initialize_points_reverse,
+    initialize_points_collinear, initialize_points_circle};
+  int ninputs = 5;
+
+  const char* kernel_names[] = {"orientation", "find_bottom_point", "merge_points",
+                                "sort_points", "build_hull", "delete_middle_points",
+                                "graham_scan_inplace", "orientation_double",
+                                "graham_scan_inplace_double", "approx_hull",
+                                "graham_scan_arena", "graham_scan_small", "hull_pair"};
+  kernel_fn kernels[] = {bench_orientation, bench_find_bottom, bench_merge,
+                         bench_sort, bench_build_hull, bench_delete_middle,
+                         bench_graham_inplace, bench_orientation_double,
+                         bench_graham_inplace_double, bench_approx_hull,
+                         bench_graham_arena, bench_graham_small, bench_hull_pair};
+  int nkernels = 13;
+
+  vector<bench_result> results;
+  for (int j = 0; j < ninputs; j++) {
+    srandom(1);
+    vector<point2d> input;
+    initializers[j](input, n);
+    for (int k = 0; k < nkernels; k++) {
+      results.push_back(run_bench(kernel_names[k], kernels[k], input_names[j], input, nsamples));
+    }
+  }
+
+  map<string, double> baseline;
+  if (baseline_path && !read_json(baseline_path, baseline)) exit(1);
+
+  int nslower = 0, nbigger = 0;
+  printf("%-36s %12s %8s %10s %12s %8s\n", "kernel/input", "ns/op", "allocs", "peak", "baseline", "change");
+  for (int i = 0; i < (int)results.size(); i++) {
+    bench_result& r = results[i];
+    char peak[32];
+    printf("%-36s %12.3f %8lld %10s", r.name.c_str(), r.ns_per_op, r.allocs,
+           hrt_sprint_bytes(peak, r.peak_bytes));
+    if (baseline.count(r.name)) {
+      double base = baseline[r.name];
+      double change = (r.ns_per_op - base) / base;
+      int slower = change > slowdown;
+      nslower += slower;
+      printf(" %12.3f %+7.1f%%%s", base, 100 * change, slower ? "  SLOWER" : "");
+    }
+    //memory is deterministic, so any growth past the allowed slowdown
+    //counts (from none to some, too)
+    string ka = r.name + ":allocs", kp = r.name + ":peak_bytes";
+    if (baseline.count(ka) && baseline.count(kp)) {
+      int bigger = r.allocs > baseline[ka] * (1 + slowdown) ||
+                   r.peak_bytes > baseline[kp] * (1 + slowdown);
+      nbigger += bigger;
+      if (bigger) {
+        printf("  MORE MEMORY (was %.0f allocs, %s peak)", baseline[ka],
+               hrt_sprint_bytes(peak, (long long)baseline[kp]));
+      }
+    }
+    printf("\n");
+  }
+
+  if (out_path && !write_json(out_path, results)) exit(1);
+
+  if (nslower > 0) {
+    printf("\n%d kernel(s) slower than the baseline by more than %.0f%%\n", nslower, 100 * slowdown);
+  }
+  if (nbigger > 0) {
+    printf("\n%d kernel(s) using more memory than the baseline by more than %.0f%%\n",
+           nbigger, 100 * slowdown);
+  }
+  if (nslower > 0 || nbigger > 0) exit(1);
+  return 0;
+}
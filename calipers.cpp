@@ -0,0 +1,264 @@
+#include "calipers.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmath>
+
+#include <vector>
+#include <utility>
+
+using namespace std;
+
+
+/* **************************************** */
+static long long dist2(point2d a, point2d b) {
+  long long dx = (long long)b.x - a.x;
+  long long dy = (long long)b.y - a.y;
+  return dx*dx + dy*dy;
+}
+
+/* returns the dot product of (b - a) and (c - a) */
+static long long dot2D(point2d a, point2d b, point2d c) {
+  return ((long long)b.x - a.x) * ((long long)c.x - a.x) + ((long long)b.y - a.y) * ((long long)c.y - a.y);
+}
+
+/*
+  returns 1 if a/b < c/d, for b, d > 0. below 2^30 the numerators are
+  up to 2^127 and the denominators up to 2^63, so the cross products do
+  not fit in 128 bits: compare the integer parts, then the fractional
+  parts by their inverses, like Euclid's algorithm
+*/
+static int fraction_less(unsigned __int128 a, unsigned __int128 b,
+                      unsigned __int128 c, unsigned __int128 d) {
+  while (true) {
+    unsigned __int128 qa = a / b, qc = c / d;
+    if (qa != qc) return qa < qc;
+    a -= qa * b;
+    c -= qc * d;
+    if (a == 0 || c == 0) return a == 0 && c != 0;
+    //a/b < c/d if and only if d/c < b/a
+    unsigned __int128 t = a;
+    a = d;
+    d = t;
+    t = b;
+    b = c;
+    c = t;
+  }
+}
+
+
+/* **************************************** */
+/*
+  fills in the rectangle corners in m, given that the rectangle has a
+  side on the line through a and b (in that direction), and touches the
+  hull at r (rightmost along ab), t (farthest from ab), l (leftmost)
+*/
+static void rect_corners(point2d a, point2d b, point2d r, point2d t, point2d l,
+                         hull_measures* m) {
+  double ex = b.x - a.x, ey = b.y - a.y;
+  double len2 = ex*ex + ey*ey;
+  double sr = dot2D(a, b, r) / len2;
+  double sl = dot2D(a, b, l) / len2;
+  double st = signed_area2D(a, b, t) / len2;
+  //a + s*e along the edge, then up by st in the direction of e rotated CCW
+  double cx[4] = {a.x + sr*ex, a.x + sr*ex - st*ey, a.x + sl*ex - st*ey, a.x + sl*ex};
+  double cy[4] = {a.y + sr*ey, a.y + sr*ey + st*ex, a.y + sl*ey + st*ex, a.y + sl*ey};
+  for (int k = 0; k < 4; k++) {
+    m->rect_corner[k].x = (int)lround(cx[k]);
+    m->rect_corner[k].y = (int)lround(cy[k]);
+  }
+}
+
+
+/* **************************************** */
+/* measures of hulls with fewer than 3 vertices (a point or a segment) */
+static void measure_degenerate(const vector<point2d>& hull, hull_measures* m) {
+  int h = hull.size();
+  memset(m, 0, sizeof(hull_measures));
+  if (h == 0) {
+    m->diam_i = m->diam_j = m->width_edge = m->width_vertex = -1;
+    m->rect_edge = m->rect_right = m->rect_top = m->rect_left = -1;
+    return;
+  }
+  m->diam_j = m->rect_right = h - 1;
+  m->diam2 = dist2(hull[0], hull[h-1]);
+  m->rect_corner[0] = m->rect_corner[3] = hull[0];
+  m->rect_corner[1] = m->rect_corner[2] = hull[h-1];
+}
+
+
+/* **************************************** */
+/*
+  the rotating calipers walk. for every edge i -> i+1 we advance three
+  pointers monotonically around the hull: t (the vertex farthest from
+  the edge), r and l (the extreme vertices along and against the edge
+  direction). the vertices antipodal to vertex i are the ones between
+  the top of edge i-1 and the top of edge i. if pairs is not NULL the
+  antipodal pairs are stored in it. if want_rect is 0, r and l are not
+  maintained and the rectangle is not computed
+*/
+static void calipers_walk(const vector<point2d>& hull, hull_measures* m,
+                          vector<pair<int,int> >* pairs, int want_rect) {
+  int h = hull.size();
+  if (h < 3) {
+    measure_degenerate(hull, m);
+    if (pairs) {
+      pairs->clear();
+      if (h == 2) pairs->push_back(make_pair(0, 1));
+    }
+    return;
+  }
+  memset(m, 0, sizeof(hull_measures));
+  if (pairs) pairs->clear();
+
+  //best width so far is width_h / sqrt(width_len2)
+  long long width_h = -1, width_len2 = 1;
+  //best rectangle so far has area rect_num / rect_len2
+  unsigned __int128 rect_num = 0;
+  long long rect_len2 = 1;
+  int have_rect = 0;
+
+  int t = 1, r = 1, l = 1;
+  int t_first = 0;  //first top of edge 0, needed to close the walk at vertex 0
+  int t_prev = 0;   //last top of the previous edge
+  for (int i = 0; i < h; i++) {
+    point2d a = hull[i];
+    point2d b = hull[(i+1) % h];
+
+    while (signed_area2D(a, b, hull[(t+1) % h]) > signed_area2D(a, b, hull[t])) {
+      t = (t + 1) % h;
+    }
+    //if the edge opposite is parallel to ab, both its endpoints are on top
+    int t_last = t;
+    if (signed_area2D(a, b, hull[(t+1) % h]) == signed_area2D(a, b, hull[t])) {
+      t_last = (t + 1) % h;
+    }
+
+    //vertex i is antipodal to everything from the previous top to this one
+    if (i == 0) {
+      t_first = t;
+    } else {
+      for (int k = t_prev; ; k = (k + 1) % h) {
+        if (k != i) {
+          long long d = dist2(hull[i], hull[k]);
+          if (d > m->diam2) {
+            m->diam2 = d;
+            m->diam_i = min(i, k);
+            m->diam_j = max(i, k);
+          }
+          if (pairs && i < k) pairs->push_back(make_pair(i, k));
+        }
+        if (k == t_last) break;
+      }
+    }
+    t_prev = t;
+
+    //width: height of the top above edge i
+    //both are positive; compare the squares of the widths
+    long long ht = signed_area2D(a, b, hull[t]);
+    long long len2 = dist2(a, b);
+    if (width_h < 0 || fraction_less((unsigned __int128)ht * ht, len2,
+                                     (unsigned __int128)width_h * width_h, width_len2)) {
+      width_h = ht;
+      width_len2 = len2;
+      m->width_edge = i;
+      m->width_vertex = t;
+    }
+
+    if (!want_rect) continue;
+
+    if (i == 0) {
+      l = t;
+    }
+    while (dot2D(a, b, hull[(r+1) % h]) > dot2D(a, b, hull[r])) {
+      r = (r + 1) % h;
+    }
+    while (dot2D(a, b, hull[(l+1) % h]) < dot2D(a, b, hull[l])) {
+      l = (l + 1) % h;
+    }
+    unsigned __int128 num = (unsigned __int128)(dot2D(a, b, hull[r]) - (__int128)dot2D(a, b, hull[l])) * ht;
+    if (!have_rect || fraction_less(num, len2, rect_num, rect_len2)) {
+      have_rect = 1;
+      rect_num = num;
+      rect_len2 = len2;
+      m->rect_edge = i;
+      m->rect_right = r;
+      m->rect_top = t;
+      m->rect_left = l;
+    }
+  }
+
+  //close the walk: vertex 0 is antipodal to the tops of edges h-1 and 0
+  for (int k = t_prev; ; k = (k + 1) % h) {
+    if (k != 0) {
+      long long d = dist2(hull[0], hull[k]);
+      if (d > m->diam2) {
+        m->diam2 = d;
+        m->diam_i = 0;
+        m->diam_j = k;
+      }
+      if (pairs) pairs->push_back(make_pair(0, k));
+    }
+    if (k == t_first) break;
+  }
+  //the parallel edge case at edge 0 was skipped above
+  int t0_last = (t_first + 1) % h;
+  if (signed_area2D(hull[0], hull[1], hull[t0_last]) == signed_area2D(hull[0], hull[1], hull[t_first])) {
+    long long d = dist2(hull[0], hull[t0_last]);
+    if (d > m->diam2) {
+      m->diam2 = d;
+      m->diam_i = 0;
+      m->diam_j = t0_last;
+    }
+    if (pairs) pairs->push_back(make_pair(0, t0_last));
+  }
+
+  m->width = width_h / sqrt((double)width_len2);
+  if (want_rect) {
+    m->rect_area = (double)rect_num / rect_len2;
+    int e = m->rect_edge;
+    rect_corners(hull[e], hull[(e+1) % h], hull[m->rect_right], hull[m->rect_top],
+                 hull[m->rect_left], m);
+  }
+}
+
+
+/* **************************************** */
+long long hull_diameter(const vector<point2d>& hull, int* i, int* j) {
+  hull_measures m;
+  calipers_walk(hull, &m, NULL, 0);
+  *i = m.diam_i;
+  *j = m.diam_j;
+  return m.diam2;
+}
+
+
+/* **************************************** */
+double hull_width(const vector<point2d>& hull, int* edge, int* vertex) {
+  hull_measures m;
+  calipers_walk(hull, &m, NULL, 0);
+  *edge = m.width_edge;
+  *vertex = m.width_vertex;
+  return m.width;
+}
+
+
+/* **************************************** */
+double hull_min_area_rect(const vector<point2d>& hull, hull_measures* m) {
+  calipers_walk(hull, m, NULL, 1);
+  return m->rect_area;
+}
+
+
+/* **************************************** */
+void hull_antipodal_pairs(const vector<point2d>& hull, vector<pair<int,int> >& pairs) {
+  hull_measures m;
+  calipers_walk(hull, &m, &pairs, 0);
+}
+
+
+/* **************************************** */
+void hull_measure_all(const vector<point2d>& hull, hull_measures* m) {
+  calipers_walk(hull, m, NULL, 1);
+}
@@ -0,0 +1,63 @@
+#ifndef __calipers_h
+#define __calipers_h
+
+#include "geom.h"
+
+#include <vector>
+#include <utility>
+
+using namespace std;
+
+
+/*
+  rotating calipers measures on a convex hull as produced by
+  graham_scan(): CCW order, no three collinear vertices. all of them
+  run in O(h) and compare exactly in integer arithmetic, for
+  coordinates of absolute value below 2^30 (like signed_area2D()); the
+  double fields are only for printing.
+*/
+
+
+/* everything hull_measure_all() computes in a single walk around the hull */
+typedef struct _hull_measures {
+  //diameter: the farthest pair of vertices
+  int diam_i, diam_j;
+  long long diam2;     //squared distance between them
+
+  //width: the minimum distance between two parallel supporting lines.
+  //it is attained by an edge and the vertex farthest from it
+  int width_edge;      //the edge hull[width_edge] -> hull[width_edge+1]
+  int width_vertex;
+  double width;
+
+  //minimum-area enclosing rectangle; one of its sides lies on rect_edge
+  //and it touches the hull at rect_edge, rect_right, rect_top, rect_left
+  int rect_edge;
+  int rect_right, rect_top, rect_left;
+  double rect_area;
+  point2d rect_corner[4]; //not exact: rounded to the nearest integer point
+} hull_measures;
+
+
+/* returns the squared diameter of the hull, and its endpoints in *i and *j */
+long long hull_diameter(const vector<point2d>& hull, int* i, int* j);
+
+/* returns the width of the hull; the edge and vertex attaining it are
+   stored in *edge and *vertex */
+double hull_width(const vector<point2d>& hull, int* edge, int* vertex);
+
+/* returns the area of the minimum-area rectangle enclosing the hull */
+double hull_min_area_rect(const vector<point2d>& hull, hull_measures* m);
+
+/*
+  stores in pairs all antipodal pairs of vertices (vertices that admit
+  parallel supporting lines). every farthest pair of the hull, and every
+  locally farthest pair, is one of them; there are at most 3h/2
+*/
+void hull_antipodal_pairs(const vector<point2d>& hull, vector<pair<int,int> >& pairs);
+
+/* computes diameter, width and minimum-area rectangle in one pass */
+void hull_measure_all(const vector<point2d>& hull, hull_measures* m);
+
+
+#endif
@@ -1,48 +1,48 @@
 #include "geom.h"
+#include "hullgeneric.h"
+#include "hrtimer.h"
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <limits.h>
+#include <string.h>
 #include <cmath>
 
 #include <vector>
+#include <algorithm>
 
 using namespace std; 
 
-//threshold for double comparison to zero
-double MARGIN = 0.000001; //10^(-6)
-
 /* **************************************** */
 /* returns the signed area of triangle abc. The area is positive if c
-   is to the left of ab, and negative if c is to the right of ab
+   is to the left of ab, and negative if c is to the right of ab.
+   computed in 64 bits, so it is exact for coordinates below 2^30
  */
-int signed_area2D(point2d a, point2d b, point2d c) {
-  int Ax = b.x - a.x;
-  int Ay = b.y - a.y;
-  int Bx = c.x - a.x;
-  int By = c.y - a.y;
+long long signed_area2D(point2d a, point2d b, point2d c) {
+  long long Ax = (long long)b.x - a.x;
+  long long Ay = (long long)b.y - a.y;
+  long long Bx = (long long)c.x - a.x;
+  long long By = (long long)c.y - a.y;
   return (Ax * By) - (Ay * Bx); 
 }
 
 /* **************************************** */
 /* return 1 if p,q,r collinear, and 0 otherwise */
 int collinear(point2d p, point2d q, point2d r) {
-  //for double comparison == 0 ?, consider a very small interval around 0
-  double result = signed_area2D(p,q,r);
-  return (result < MARGIN) && (result > -MARGIN); // ==0 0
+  //the area is exact, so no tolerance is needed
+  return signed_area2D(p,q,r) == 0;
 }
 
 /* **************************************** */
 /* return 1 if c is  strictly left of ab; 0 otherwise */
 int left_strictly(point2d a, point2d b, point2d c) {
-  //for double comparison to 0, consider a very small interval around 0 to be == 0
-  return signed_area2D(a,b,c) > MARGIN; // > 0
+  return signed_area2D(a,b,c) > 0;
 }
 
 
 /* return 1 if c is left of ab or on ab; 0 otherwise */
 int left_on(point2d a, point2d b, point2d c) {
-  //for double comparison to 0, consider a very small interval around 0 to be == 0
-  return signed_area2D(a,b,c) > -MARGIN; // >= 0
+  return signed_area2D(a,b,c) >= 0;
 }
 
 /*
@@ -70,6 +70,83 @@ int find_bottom_point(vector<point2d>& pts){
 }
 
 
+/*
+  galloping search in the sorted a[0..n): returns how many points of a
+  go before key, counting points equal to key if right is set. it probes
+  a[0], a[2], a[6], a[14], ... and then binary searches, so it costs
+  O(log i) for an answer i: cheap when the answer is near the front
+*/
+static int gallop(point2d p0, point2d key, const point2d* a, int n, int right){
+  int lo = 0, hi = 1;
+  //a[i] goes before key iff (right ? !(key before a[i]) : a[i] before key)
+  while (hi <= n){
+    int in = right ? !radial_before(p0, key, a[hi-1]) : radial_before(p0, a[hi-1], key);
+    if (!in) break;
+    lo = hi;
+    hi = 2 * hi + 1;
+  }
+  if (hi > n) hi = n + 1;
+  //a[0..lo) go before key, a[hi-1] does not (or is past the end)
+  hi--;
+  while (lo < hi){
+    int mid = lo + (hi - lo) / 2;
+    int in = right ? !radial_before(p0, key, a[mid]) : radial_before(p0, a[mid], key);
+    if (in) lo = mid + 1; else hi = mid;
+  }
+  return lo;
+}
+
+//after this many wins in a row from one run, the merge starts galloping
+#define MIN_GALLOP 7
+
+/*
+  merges the sorted runs a[0..n1) and a[n1..n1+n2), stably. tmp must
+  hold n1 points. the points of the first run that are already in place
+  (before the start of the second run), and those of the second run
+  after the end of the first, are found by galloping and not moved
+*/
+static void merge_runs(point2d p0, point2d* a, int n1, int n2, point2d* tmp){
+  int k = gallop(p0, a[n1], a, n1, 1);
+  a += k;
+  n1 -= k;
+  if (n1 == 0) return;
+  n2 = gallop(p0, a[n1-1], a + n1, n2, 0);
+  if (n2 == 0) return;
+
+  copy(a, a + n1, tmp);
+  point2d* b = a + n1;
+  int i = 0, j = 0, w = 0;
+  int wins1 = 0, wins2 = 0;
+  while (i < n1 && j < n2){
+    if (radial_before(p0, b[j], tmp[i])){
+      a[w++] = b[j++];
+      wins2++;
+      wins1 = 0;
+    } else {
+      a[w++] = tmp[i++];
+      wins1++;
+      wins2 = 0;
+    }
+    //one run keeps winning: copy its whole block ahead of the other in one go
+    if (wins1 >= MIN_GALLOP && i < n1 && j < n2){
+      int c = gallop(p0, b[j], tmp + i, n1 - i, 1);
+      copy(tmp + i, tmp + i + c, a + w);
+      i += c;
+      w += c;
+      wins1 = 0;
+    } else if (wins2 >= MIN_GALLOP && i < n1 && j < n2){
+      int c = gallop(p0, tmp[i], b + j, n2 - j, 0);
+      //b[j..j+c) move down to a[w..); w <= n1 + j, so this never overwrites them first
+      copy(b + j, b + j + c, a + w);
+      j += c;
+      w += c;
+      wins2 = 0;
+    }
+  }
+  //what is left of the second run is already in place
+  copy(tmp + i, tmp + n1, a + w);
+}
+
 /*
   the merge function for a mergesort sorting radially in counterclockwise order with respect to p0
   start and p1stop are the indices in pts_unmerged where sorted p1 and p2 begin
@@ -78,87 +155,125 @@ int find_bottom_point(vector<point2d>& pts){
   pts_unsorted[0] should be p0 (the point that we are sorting by)
 */
 void merge_points(vector<point2d>& pts_unmerged, int start, int p1_stop, int p2_stop){
-  vector<point2d> pts_merged;
-  //copy pts_merged into pts_unmerged
-  for (int i = start; i < p2_stop; i++){
-    point2d p;
-    p.x = pts_unmerged[i].x;
-    p.y = pts_unmerged[i].y;
-    pts_merged.push_back(p);
-  }
-
-  int next_p1 = start; //pointer to pts_unsorted where next p1 point is
-  int next_p2 = p1_stop; //pointer to pts_unsorted where next p2 point is
-  point2d p0 = pts_unmerged[0];
-  for (int i = 0; i < (p2_stop - start); i++){
-    
-    if ((next_p1 < p1_stop) && (next_p2 < p2_stop)){
-      if (left_strictly(p0, pts_unmerged[next_p1], pts_unmerged[next_p2])){
-        pts_merged[i].x = pts_unmerged[next_p1].x;
-        pts_merged[i].y = pts_unmerged[next_p1].y;
-        next_p1 += 1;
-      }else if (collinear(p0, pts_unmerged[next_p1], pts_unmerged[next_p2])){
-      //if two points are collinear with p0, then sort by their x and y distance from p0
-        if (abs(p0.x - pts_unmerged[next_p1].x) < abs(p0.x - pts_unmerged[next_p2].x)){
-          pts_merged[i].x = pts_unmerged[next_p1].x;
-          pts_merged[i].y = pts_unmerged[next_p1].y;
-          next_p1 += 1;
-          //NOTE: another option would be do delete the closer point, but this would require reallocating the array
-        } else if (abs(p0.y - pts_unmerged[next_p1].y) < abs(p0.y - pts_unmerged[next_p2].y)){ //if the points have the same x
-          pts_merged[i].x = pts_unmerged[next_p1].x;
-          pts_merged[i].y = pts_unmerged[next_p1].y;
-          next_p1 += 1;
-        } else{ // p2 point is closer than p1 point
-          pts_merged[i].x = pts_unmerged[next_p2].x;
-          pts_merged[i].y = pts_unmerged[next_p2].y;
-          next_p2 += 1;
-        }
-      } else{ //p1 point is left of p2
-        pts_merged[i].x = pts_unmerged[next_p2].x;
-          pts_merged[i].y = pts_unmerged[next_p2].y;
-        next_p2 += 1;
+  vector<point2d> tmp(p1_stop - start);
+  merge_runs(pts_unmerged[0], pts_unmerged.data() + start, p1_stop - start, p2_stop - p1_stop, tmp.data());
+}
+
+/*
+  the length of the shortest run: n itself if n < 64, else a number in
+  [32, 64] such that n / minrun is a power of two or a bit less, so the
+  merges stay balanced (as in TimSort)
+*/
+static int min_run_length(int n){
+  int r = 0;
+  while (n >= 64){
+    r |= n & 1;
+    n >>= 1;
+  }
+  return n + r;
+}
+
+/*
+  natural mergesort (TimSort without its refinements): the input is cut
+  into the runs already in it, ascending or descending (those are
+  reversed), and runs shorter than minrun are extended with binary
+  insertion sort. the runs are merged from a stack that keeps their
+  lengths decreasing at least like the Fibonacci numbers, so the merges
+  are balanced. input that is sorted, or sorted backwards, is one run
+  and costs n - 1 comparisons; a few runs cost O(n log(runs)). tmp must
+  hold n points; nothing else is allocated
+*/
+
+//the run lengths on the stack grow at least like the Fibonacci
+//numbers, so 2^31 points never need more than this many runs
+#define MAX_RUNS 64
+
+/* merges runs m and m + 1 of the stack and pops the second one */
+static void merge_at(point2d p0, point2d* a, int* run_start, int* run_len, int& nruns, int m,
+                     point2d* tmp){
+  merge_runs(p0, a + run_start[m], run_len[m], run_len[m+1], tmp);
+  run_len[m] += run_len[m+1];
+  for (int r = m + 1; r + 1 < nruns; r++){
+    run_start[r] = run_start[r+1];
+    run_len[r] = run_len[r+1];
+  }
+  nruns--;
+}
+
+static void natural_mergesort(point2d p0, point2d* a, int n, point2d* tmp){
+  if (n < 2) return;
+  int minrun = min_run_length(n);
+  //start and length of the runs not merged yet, bottom first
+  int run_start[MAX_RUNS], run_len[MAX_RUNS];
+  int nruns = 0;
+
+  int i = 0;
+  while (i < n){
+    //find the run starting at i
+    int j = i + 1;
+    if (j < n){
+      if (radial_before(p0, a[j], a[i])){
+        //equal points are copies of each other, so the run can take
+        //them too: reversing it cannot swap two distinguishable points
+        while (j + 1 < n && !radial_before(p0, a[j], a[j+1])) j++;
+        reverse(a + i, a + j + 1);
+      } else {
+        while (j + 1 < n && !radial_before(p0, a[j+1], a[j])) j++;
       }
-    } else if (next_p1 < p1_stop){ //only points left in P1
-      pts_merged[i].x = pts_unmerged[next_p1].x;
-      pts_merged[i].y = pts_unmerged[next_p1].y;
-      next_p1 += 1;
-    } else{ //if (next_p2 < p2_stop) //only points left in P2
-      pts_merged[i].x = pts_unmerged[next_p2].x;
-      pts_merged[i].y = pts_unmerged[next_p2].y;
-      next_p2 += 1;
+      j++;
     }
-  }
+    //extend it to minrun points
+    int end = min(n, i + minrun);
+    for (; j < end; j++){
+      point2d p = a[j];
+      int pos = i + gallop(p0, p, a + i, j - i, 1);
+      copy_backward(a + pos, a + j, a + j + 1);
+      a[pos] = p;
+    }
+    assert(nruns < MAX_RUNS);
+    run_start[nruns] = i;
+    run_len[nruns] = j - i;
+    nruns++;
+    i = j;
 
-  //copy pts_merged into pts_unmerged
-  for (int i = 0; i < (p2_stop - start); i++){
-    pts_unmerged[start + i].x = pts_merged[i].x;
-    pts_unmerged[start + i].y = pts_merged[i].y;
+    //merge until the stack invariants hold: with run lengths
+    //A, B, C on top (C last), A > B + C and B > C
+    while (nruns > 1){
+      int m = nruns - 2; //merge runs m and m+1
+      if (m > 0 && run_len[m-1] <= run_len[m] + run_len[m+1]){
+        if (run_len[m-1] < run_len[m+1]) m--;
+      } else if (m > 1 && run_len[m-2] <= run_len[m-1] + run_len[m]){
+        if (run_len[m-1] < run_len[m+1]) m--;
+      } else if (run_len[m] > run_len[m+1]){
+        break;
+      }
+      merge_at(p0, a, run_start, run_len, nruns, m, tmp);
+    }
+  }
+  //merge the rest, top first
+  while (nruns > 1){
+    int m = nruns - 2;
+    if (m > 0 && run_len[m-1] < run_len[m+1]) m--;
+    merge_at(p0, a, run_start, run_len, nruns, m, tmp);
   }
 }
 
 /*
-  recursive sort helper function
-  
-  radially sort all other points in a vector of points in relation to p0,
-    using mergesort
-  the first point in the given vector of points should be p0 (the point to compare to)
+  radially sorts pts[start..stop) in relation to p0 = pts[0], with a
+  natural mergesort (see above), so input that is already partly in
+  order (points along a contour, or a generator that walks a circle)
+  sorts in close to linear time
 
   start is the first index of the section of the vector to sort, stop is 1 + the last index to sort
 */
 void sort_points(vector<point2d>& pts, int start, int stop){
-  //base case: only 1 or 0 points (excluding P0)
-  if ((stop - start) < 2){
-    return;
-  } else { //recursive case: recurse on 2 halves then merge
-    int midpoint = start + ((stop - start) / 2);
-    sort_points(pts, start, midpoint);
-    sort_points(pts, midpoint, stop);
-    merge_points(pts, start, midpoint, stop);
-  }
+  if (stop - start < 2) return;
+  vector<point2d> tmp(stop - start);
+  natural_mergesort(pts[0], pts.data() + start, stop - start, tmp.data());
 }
 
 /*
-  caller function for recursive mergesort sort_points()
+  caller function for sort_points()
     which radially sorts points with respect to p0
 */
 void sort_points(vector<point2d>& pts){
@@ -172,14 +287,17 @@ void sort_points(vector<point2d>& pts){
 */
 void build_hull(vector<point2d>& pts, vector<point2d>& hull){
   hull.push_back(pts[0]); //add p0 to the hull
-  hull.push_back(pts[1]); //push the next point onto the hull
-  int i = 2;
+  int i = 1;
   while(i < pts.size()){
-    if (left_strictly(hull[hull.size()-2], hull[hull.size()-1], pts[i])){
-      hull.push_back(pts[i]);
+    if (hull.size() < 2 || left_strictly(hull[hull.size()-2], hull[hull.size()-1], pts[i])){
+      //skip copies of p0 (they sort right after it)
+      if (hull.size() > 1 || pts[i].x != pts[0].x || pts[i].y != pts[0].y){
+        hull.push_back(pts[i]);
+      }
       i++;
     }else{
-      while (!left_strictly(hull[hull.size()-2], hull[hull.size()-1], pts[i])){
+      //stop at p0: if all the points so far are collinear only p0 is left
+      while (hull.size() >= 2 && !left_strictly(hull[hull.size()-2], hull[hull.size()-1], pts[i])){
         hull.pop_back();
         //NOTE: collinear points have been sorted in order going out, so the later point should be kept on the hull
         //and the previous point should be removed (so it is the same procedure as for convex --> right-of)
@@ -249,7 +367,7 @@ vector<point2d> delete_middle_points(vector<point2d>& pts){
       int jnext = (j + 1) % pts_extreme.size();
       if (!left_on(pts_extreme[j], pts_extreme[jnext], p)){
         pts_outside.push_back(p);
-        continue;
+        break; //only add p once, even if it is outside several edges
       }
     }
   }
@@ -260,27 +378,55 @@ vector<point2d> delete_middle_points(vector<point2d>& pts){
 // compute the convex hull of pts, and store the points on the hull in hull
 void graham_scan(vector<point2d>& pts, vector<point2d>& hull ) {
 
+  //a few points: the sorting network, with no printing or timing
+  if (pts.size() <= SMALL_HULL_MAX){
+    hull.resize(pts.size());
+    hull.resize(small_hull(pts.data(), pts.size(), hull.data()));
+    return;
+  }
+
   printf("hull2d (graham scan): start\n"); 
+  HRT_SCOPE("graham_scan");
   hull.clear(); //should be empty, but clear it to be safe
+  if (pts.empty()) return;
+
+  //many points in few x columns: no need to sort
+  int xmin, xmax;
+  x_range(pts.data(), pts.size(), &xmin, &xmax);
+  if (column_hull_pays(pts.size(), xmin, xmax)){
+    column_hull(pts.data(), pts.size(), xmin, xmax, hull);
+    printf("hull2d (graham scan): end (column hull)\n"); 
+    return;
+  }
 
   //remove points cointained within the quadrilateral (or triangle) with points at x and y extremes
-  vector<point2d> pts_include = delete_middle_points(pts);
+  vector<point2d> pts_include;
+  {
+    HRT_SCOPE("filter");
+    pts_include = delete_middle_points(pts);
+  }
   //vector<point2d> pts_include = pts;
   
-  //find bottommost point p0
-  int indexP0 = find_bottom_point(pts_include);
-  //to move P0 to the front of the vector, swap with the first point:
-  int p0x = pts_include[indexP0].x; //save copy of x and y of P0
-  int p0y = pts_include[indexP0].y;
-  pts_include[indexP0].x = pts_include[0].x; //overwrite x and y of P0 with pts[0]
-  pts_include[indexP0].y = pts_include[0].y;
-  pts_include[0].x = p0x; //copy saved values back into 0th position
-  pts_include[0].y = p0y;
+  {
+    HRT_SCOPE("sort");
+    //find bottommost point p0
+    int indexP0 = find_bottom_point(pts_include);
+    //to move P0 to the front of the vector, swap with the first point:
+    int p0x = pts_include[indexP0].x; //save copy of x and y of P0
+    int p0y = pts_include[indexP0].y;
+    pts_include[indexP0].x = pts_include[0].x; //overwrite x and y of P0 with pts[0]
+    pts_include[indexP0].y = pts_include[0].y;
+    pts_include[0].x = p0x; //copy saved values back into 0th position
+    pts_include[0].y = p0y;
   
-  //radially sort all other points in relation to p0
-  sort_points(pts_include);
+    //radially sort all other points in relation to p0
+    sort_points(pts_include);
+  }
 
-  build_hull(pts_include, hull);
+  {
+    HRT_SCOPE("scan");
+    build_hull(pts_include, hull);
+  }
 
   
 
@@ -288,3 +434,287 @@ void graham_scan(vector<point2d>& pts, vector<point2d>& hull ) {
   return; 
 }
 
+
+
+/* keeps a filter survivor by moving it down to pts[k] */
+struct keep_in_place {
+  point2d* pts;
+  int k;
+  void operator()(int i, point2d p){ pts[k++] = p; }
+};
+
+/*
+  the filter of delete_middle_points(), in place: moves the points
+  strictly outside the quadrilateral of the x and y extremes to the front
+  of pts, followed by the (distinct) extremes themselves. returns how
+  many points were kept
+*/
+static int delete_middle_points_inplace(point2d* pts, int n){
+  keep_in_place keep = {pts, 0};
+  return hull_filter_extremes(pts, n, keep);
+}
+
+
+// in-place graham scan; the hull ends up in pts[0..h)
+int graham_scan_inplace(point2d* pts, int n){
+  if (n <= SMALL_HULL_MAX) return small_hull(pts, n, pts);
+  HRT_SCOPE("graham_scan_inplace");
+
+  int k;
+  {
+    HRT_SCOPE("filter");
+    k = delete_middle_points_inplace(pts, n);
+  }
+
+  {
+    HRT_SCOPE("sort");
+    //move the bottom point p0 to the front and sort the rest around it
+    radial_less<point_itself> less(point_itself(), move_bottom_first(pts, k, point_itself()));
+    sort(pts + 1, pts + k, less);
+  }
+
+  HRT_SCOPE("scan");
+  return hull_scan_sorted(pts, k, point_itself());
+}
+
+int graham_scan_inplace(vector<point2d>& pts){
+  int h = graham_scan_inplace(pts.data(), pts.size());
+  pts.resize(h); //shrinking does not reallocate
+  return h;
+}
+
+
+/* **************************************** */
+/*
+  small hulls. below a few dozen points the filter, the sort and the
+  bookkeeping around them cost more than the hull itself, so the points
+  are copied to the stack, padded with copies of p0 to a fixed size N,
+  sorted by a sorting network, and scanned. the padding sorts first
+  (copies of p0 go before everything) and the scan skips it. the
+  network is a table built at compile time, so the sort is a straight
+  run of compare-exchanges at fixed positions
+*/
+
+/* puts a and b in radial order; the swap is done with masks on the 64
+   bits of a point, so it does not branch on the order of the input */
+static inline void compare_exchange(point2d& a, point2d& b){
+  unsigned long long ua, ub;
+  memcpy(&ua, &a, sizeof(ua));
+  memcpy(&ub, &b, sizeof(ub));
+  //the points are vectors from p0, so they are sorted around the origin
+  point2d o = {0, 0};
+  unsigned long long m = -(unsigned long long)radial_before(o, b, a);
+  unsigned long long lo = (ub & m) | (ua & ~m), hi = (ua & m) | (ub & ~m);
+  memcpy(&a, &lo, sizeof(lo));
+  memcpy(&b, &hi, sizeof(hi));
+}
+
+/* the compare-exchanges of Batcher's odd-even mergesort of N elements,
+   listed at compile time */
+template <int N>
+struct sorting_network {
+  int size;
+  unsigned char lo[N * N / 2], hi[N * N / 2];
+  constexpr sorting_network() : size(0), lo(), hi() {
+    for (int p = 1; p < N; p <<= 1){
+      for (int k = p; k >= 1; k >>= 1){
+        for (int j = k % p; j + k < N; j += 2 * k){
+          for (int i = 0; i < k && i + j + k < N; i++){
+            if ((i + j) / (2 * p) == (i + j + k) / (2 * p)){
+              lo[size] = i + j;
+              hi[size] = i + j + k;
+              size++;
+            }
+          }
+        }
+      }
+    }
+  }
+};
+
+/* small_hull() for n <= N */
+template <int N>
+static int small_hull_n(const point2d* pts, int n, point2d* hull){
+  static_assert(sizeof(point2d) == sizeof(unsigned long long), "point2d is two ints");
+  static constexpr sorting_network<N> net;
+
+  int i0 = 0;
+  for (int i = 1; i < n; i++){
+    int lower = pts[i].y < pts[i0].y || (pts[i].y == pts[i0].y && pts[i].x > pts[i0].x);
+    i0 = lower ? i : i0;
+  }
+  point2d p0 = pts[i0];
+
+  //sorted as vectors from p0 (which fit in an int, the coordinates being
+  //below 2^30), so a comparison is one cross product. p0 itself stays
+  //among them: as a copy of p0 it is skipped like the padding
+  point2d v[N];
+  for (int i = 0; i < n; i++){
+    v[i].x = pts[i].x - p0.x;
+    v[i].y = pts[i].y - p0.y;
+  }
+  for (int i = n; i < N; i++) v[i].x = v[i].y = 0;
+  for (int c = 0; c < net.size; c++) compare_exchange(v[net.lo[c]], v[net.hi[c]]);
+
+  point2d buf[N + 1];
+  buf[0] = p0;
+  for (int i = 0; i < N; i++){
+    buf[i + 1].x = v[i].x + p0.x;
+    buf[i + 1].y = v[i].y + p0.y;
+  }
+  int h = hull_scan_sorted(buf, N + 1, point_itself());
+  for (int i = 0; i < h; i++) hull[i] = buf[i];
+  return h;
+}
+
+int small_hull(const point2d* pts, int n, point2d* hull){
+  assert(n <= SMALL_HULL_MAX);
+  if (n == 0) return 0;
+  if (n <= 8) return small_hull_n<8>(pts, n, hull);
+  if (n <= 16) return small_hull_n<16>(pts, n, hull);
+  return small_hull_n<32>(pts, n, hull);
+}
+
+
+/* **************************************** */
+/*
+  one monotone chain pass over p[0..m), sorted by x (copies of a point
+  may repeat): appends the chain, turning left, to out
+*/
+static void monotone_chain(const point2d* p, int m, vector<point2d>& out){
+  size_t base = out.size();
+  for (int i = 0; i < m; i++){
+    while (out.size() >= base + 2 && !left_strictly(out[out.size()-2], out.back(), p[i])){
+      out.pop_back();
+    }
+    if (out.size() == base + 1 && out.back().x == p[i].x && out.back().y == p[i].y) continue;
+    out.push_back(p[i]);
+  }
+}
+
+/*
+  the column hull with the column arrays given: lo[c] and hi[c] get the
+  lowest and highest y in column xmin + c, and cand room for the
+  candidates of one chain (xmax - xmin + 2 points)
+*/
+static void column_hull_in(const point2d* pts, int n, int xmin, int xmax,
+                           int* lo, int* hi, point2d* cand, vector<point2d>& hull){
+  hull.clear();
+  if (n == 0) return;
+  int w = xmax - xmin + 1;
+  for (int c = 0; c < w; c++){
+    lo[c] = INT_MAX;
+    hi[c] = INT_MIN;
+  }
+  for (int i = 0; i < n; i++){
+    int c = pts[i].x - xmin;
+    if (pts[i].y < lo[c]) lo[c] = pts[i].y;
+    if (pts[i].y > hi[c]) hi[c] = pts[i].y;
+  }
+
+  //lower chain: the bottoms of the columns left to right, then the top
+  //of the last one. upper chain: the tops right to left, then the bottom
+  //of the first one. each chain ends where the other starts
+  int m = 0;
+  for (int c = 0; c < w; c++){
+    if (lo[c] > hi[c]) continue;
+    cand[m].x = xmin + c;
+    cand[m].y = lo[c];
+    m++;
+  }
+  cand[m].x = xmax;
+  cand[m].y = hi[w-1];
+  monotone_chain(cand, m + 1, hull);
+  hull.pop_back();
+
+  m = 0;
+  for (int c = w - 1; c >= 0; c--){
+    if (lo[c] > hi[c]) continue;
+    cand[m].x = xmin + c;
+    cand[m].y = hi[c];
+    m++;
+  }
+  cand[m].x = xmin;
+  cand[m].y = lo[0];
+  monotone_chain(cand, m + 1, hull);
+  hull.pop_back();
+  //all the points are copies of one point
+  if (hull.empty()) hull.push_back(pts[0]);
+
+  //bottom point first, rightmost if tied
+  int b = 0;
+  for (int i = 1; i < (int)hull.size(); i++){
+    if (hull[i].y < hull[b].y || (hull[i].y == hull[b].y && hull[i].x > hull[b].x)) b = i;
+  }
+  rotate(hull.begin(), hull.begin() + b, hull.end());
+}
+
+void column_hull(const point2d* pts, int n, int xmin, int xmax, vector<point2d>& hull){
+  HRT_SCOPE("column_hull");
+  long long w = (long long)xmax - xmin + 1;
+  vector<int> lo(w), hi(w);
+  vector<point2d> cand(w + 1);
+  column_hull_in(pts, n, xmin, xmax, lo.data(), hi.data(), cand.data(), hull);
+}
+
+void column_hull(const vector<point2d>& pts, vector<point2d>& hull){
+  hull.clear();
+  if (pts.empty()) return;
+  int xmin, xmax;
+  x_range(pts.data(), pts.size(), &xmin, &xmax);
+  column_hull(pts.data(), pts.size(), xmin, xmax, hull);
+}
+
+void x_range(const point2d* pts, int n, int* xmin, int* xmax){
+  *xmin = *xmax = pts[0].x;
+  for (int i = 1; i < n; i++){
+    if (pts[i].x < *xmin) *xmin = pts[i].x;
+    if (pts[i].x > *xmax) *xmax = pts[i].x;
+  }
+}
+
+int column_hull_pays(long n, int xmin, int xmax){
+  long long w = (long long)xmax - xmin + 1;
+  return w <= COLUMN_HULL_MAX_WIDTH && w <= (long long)COLUMN_HULL_COLUMNS_PER_POINT * n;
+}
+
+
+/*
+  graham_scan() with its scratch memory from mr: the copy of the input
+  and the buffer of the mergesort are the only allocations, and with a
+  hull_arena (hullarena.h) they cost nothing once it has grown. it
+  neither prints nor opens timing scopes, so threads can call it with
+  arenas of their own
+*/
+void graham_scan(const vector<point2d>& pts, vector<point2d>& hull, pmr::memory_resource* mr){
+  if (pts.size() <= SMALL_HULL_MAX){
+    hull.resize(pts.size());
+    hull.resize(small_hull(pts.data(), pts.size(), hull.data()));
+    return;
+  }
+  hull.clear();
+
+  int xmin, xmax;
+  x_range(pts.data(), pts.size(), &xmin, &xmax);
+  if (column_hull_pays(pts.size(), xmin, xmax)){
+    int w = xmax - xmin + 1;
+    pmr::vector<int> lo(w, mr), hi(w, mr);
+    pmr::vector<point2d> cand(w + 1, mr);
+    column_hull_in(pts.data(), pts.size(), xmin, xmax, lo.data(), hi.data(), cand.data(), hull);
+    return;
+  }
+
+  pmr::vector<point2d> buf(pts.begin(), pts.end(), mr);
+  point2d* p = buf.data();
+  int k = delete_middle_points_inplace(p, buf.size());
+
+  //move the bottom point p0 to the front and sort the rest around it
+  point2d p0 = move_bottom_first(p, k, point_itself());
+  {
+    pmr::vector<point2d> tmp(k, mr);
+    natural_mergesort(p0, p + 1, k - 1, tmp.data());
+  }
+
+  int h = hull_scan_sorted(p, k, point_itself());
+  hull.assign(p, p + h);
+}
@@ -2,6 +2,7 @@
 #define __geom_h
 
 #include <vector>
+#include <memory_resource>
 
 using namespace std; 
 
@@ -14,9 +15,11 @@ typedef struct _point2d {
 
 /* returns 2 times the signed area of triangle abc. The area is
    positive if c is to the left of ab, 0 if a,b,c are collinear and
-   negative if c is to the right of ab
+   negative if c is to the right of ab. It is computed exactly in 64
+   bits for coordinates below 2^30 in absolute value. (for points
+   with double coordinates see geomf.h)
  */
-int signed_area2D(point2d a, point2d b, point2d c); 
+long long signed_area2D(point2d a, point2d b, point2d c); 
 
 
 /* return 1 if p,q,r collinear, and 0 otherwise */
@@ -45,8 +48,10 @@ int find_bottom_point(vector<point2d>& pts);
 void merge_points(vector<point2d>& pts_unmerged, int start, int p1_stop, int p2_stop);
 
 /*
-  recursive mergesort function
+  natural mergesort function
   radially sort all other points in a vector of points in relation to p0,
+  merging the ascending and descending runs already in the input, so
+  input that is sorted (or sorted backwards) takes O(n)
 
   the first point in the given vector of points should be p0 (the point to compare to)
   start is the first index of the section of the vector to sort, stop is 1 + the last index to sort
@@ -54,10 +59,17 @@ void merge_points(vector<point2d>& pts_unmerged, int start, int p1_stop, int p2_
 void sort_points(vector<point2d>& pts, int start, int stop);
 
 /*
-  caller function for recursive mergesort sort_points()
+  caller function for mergesort sort_points()
 */
 void sort_points(vector<point2d>& pts);
 
+/*
+  finds the extreme points in the x and y directions
+  and returns a vector of points with only these and the points
+  OUTSIDE of the quadrilateral that they create
+*/
+vector<point2d> delete_middle_points(vector<point2d>& pts);
+
 /* 
   finds convex hull
   given an array of points already sorted with p0 first and all sequential points forted radially by p0
@@ -67,6 +79,63 @@ void build_hull(vector<point2d>& pts, vector<point2d>& hull);
 
 // compute the convex hull, given a totally unsorted list of points pts
 void graham_scan(vector<point2d>& pts, vector<point2d>& hull);
+
+/*
+  in-place graham scan: filters, sorts and scans inside pts itself, using
+  the prefix of the array as the hull stack, so it needs no memory besides
+  the input (the sort uses O(log n) stack).
+  returns h, the number of points on the hull; the hull is then in
+  pts[0..h) in the same order as graham_scan() produces. the rest of pts
+  is overwritten. the vector version also shrinks pts to h points
+*/
+int graham_scan_inplace(point2d* pts, int n);
+int graham_scan_inplace(vector<point2d>& pts);
+
+/*
+  hull of integer points with a narrow x range, in O(n + W) where W is
+  xmax - xmin + 1: one pass keeps the lowest and highest y of every x
+  column, and a monotone chain pass over those (already in x order)
+  gives the hull, so nothing is sorted. pts must have x in [xmin, xmax].
+  the hull is in the same order as graham_scan(). it needs 4W ints of
+  memory
+*/
+void column_hull(const point2d* pts, int n, int xmin, int xmax, vector<point2d>& hull);
+void column_hull(const vector<point2d>& pts, vector<point2d>& hull);
+
+/* the smallest and largest x in pts[0..n), n > 0 */
+void x_range(const point2d* pts, int n, int* xmin, int* xmax);
+
+/*
+  return 1 if column_hull() is faster than sorting for n points with x
+  in [xmin, xmax]. on random points it beats graham_scan_inplace() up to
+  about 3 columns per point, so it is picked up to 2, and up to 4M
+  columns (64MB). graham_scan() uses it to pick the engine
+*/
+#define COLUMN_HULL_COLUMNS_PER_POINT  2
+#define COLUMN_HULL_MAX_WIDTH          (1 << 22)
+int column_hull_pays(long n, int xmin, int xmax);
+
+/*
+  hull of a few points (n <= SMALL_HULL_MAX), for callers with many
+  small hulls: everything is on the stack, the radial sort is a
+  sorting network of branch-free compare-exchanges, unrolled for 8, 16
+  or 32 points, and there is no filter, printing or timing. returns h and puts the hull
+  in hull[0..h), in the same order as graham_scan(); hull has room for
+  n points, and may be pts. graham_scan() and graham_scan_inplace()
+  call it for n <= SMALL_HULL_MAX
+*/
+#define SMALL_HULL_MAX  32
+int small_hull(const point2d* pts, int n, point2d* hull);
+
+/*
+  graham_scan() that takes its scratch buffers from the memory
+  resource mr instead of the heap, and neither prints nor times (no
+  HRT_SCOPE), so it is safe to call from several threads. pts is not
+  changed; hull is assigned, so a hull vector that is reused keeps
+  its capacity. with a hull_arena that is reset between calls
+  (hullarena.h), repeated hulls allocate nothing in steady state
+*/
+void graham_scan(const vector<point2d>& pts, vector<point2d>& hull, pmr::memory_resource* mr);
   
 
 #endif
@@ -0,0 +1,335 @@
+#include "geomf.h"
+#include "hrtimer.h"
+#include <assert.h>
+#include <stdio.h>
+#include <math.h>
+
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+
+/* **************************************** */
+/*
+  exact arithmetic on expansions, after J. R. Shewchuk, "Adaptive
+  Precision Floating-Point Arithmetic and Fast Robust Geometric
+  Predicates" (1997). an expansion is a sum of non-overlapping doubles,
+  smallest first. the basic operations compute a rounded result x and
+  its rounding error y exactly, so that a op b = x + y
+*/
+
+//2^-53, the unit roundoff of double
+static const double EPS = 1.1102230246251565e-16;
+//2^27 + 1, to split a double into two halves of 26 bits
+static const double SPLITTER = 134217729.0;
+
+//error bounds of the three stages of orient2d
+static const double CCW_ERRBOUND_A = (3.0 + 16.0 * EPS) * EPS;
+static const double CCW_ERRBOUND_B = (2.0 + 12.0 * EPS) * EPS;
+static const double CCW_ERRBOUND_C = (9.0 + 64.0 * EPS) * EPS * EPS;
+static const double RESULT_ERRBOUND = (3.0 + 8.0 * EPS) * EPS;
+
+static long exact_count = 0;
+
+
+static inline void fast_two_sum(double a, double b, double& x, double& y) {
+  x = a + b;
+  double bvirt = x - a;
+  y = b - bvirt;
+}
+
+static inline void two_sum(double a, double b, double& x, double& y) {
+  x = a + b;
+  double bvirt = x - a;
+  double avirt = x - bvirt;
+  double bround = b - bvirt;
+  double around = a - avirt;
+  y = around + bround;
+}
+
+/* the error of x = a - b */
+static inline double two_diff_tail(double a, double b, double x) {
+  double bvirt = a - x;
+  double avirt = x + bvirt;
+  double bround = bvirt - b;
+  double around = a - avirt;
+  return around + bround;
+}
+
+static inline void two_diff(double a, double b, double& x, double& y) {
+  x = a - b;
+  y = two_diff_tail(a, b, x);
+}
+
+static inline void split(double a, double& hi, double& lo) {
+  double c = SPLITTER * a;
+  double abig = c - a;
+  hi = c - abig;
+  lo = a - hi;
+}
+
+static inline void two_product(double a, double b, double& x, double& y) {
+  x = a * b;
+  double ahi, alo, bhi, blo;
+  split(a, ahi, alo);
+  split(b, bhi, blo);
+  double err1 = x - ahi * bhi;
+  double err2 = err1 - alo * bhi;
+  double err3 = err2 - ahi * blo;
+  y = alo * blo - err3;
+}
+
+/* (a1 + a0) - (b1 + b0) as the 4-component expansion x */
+static inline void two_two_diff(double a1, double a0, double b1, double b0, double* x) {
+  double i, j, k, l;
+  two_diff(a0, b0, i, x[0]);
+  two_sum(a1, i, j, k);
+  two_diff(k, b1, i, x[1]);
+  two_sum(j, i, l, x[2]);
+  x[3] = l;
+}
+
+/* h = e + f, without zero components; returns the length of h. e and
+   f are read one element past their length, so they need room for it */
+static int expansion_sum(int elen, const double* e, int flen, const double* f, double* h) {
+  double q, qnew, hh;
+  double enow = e[0], fnow = f[0];
+  int ei = 0, fi = 0, hi = 0;
+  if ((fnow > enow) == (fnow > -enow)) {
+    q = enow;
+    enow = e[++ei];
+  } else {
+    q = fnow;
+    fnow = f[++fi];
+  }
+  if (ei < elen && fi < flen) {
+    if ((fnow > enow) == (fnow > -enow)) {
+      fast_two_sum(enow, q, qnew, hh);
+      enow = e[++ei];
+    } else {
+      fast_two_sum(fnow, q, qnew, hh);
+      fnow = f[++fi];
+    }
+    q = qnew;
+    if (hh != 0.0) h[hi++] = hh;
+    while (ei < elen && fi < flen) {
+      if ((fnow > enow) == (fnow > -enow)) {
+        two_sum(q, enow, qnew, hh);
+        enow = e[++ei];
+      } else {
+        two_sum(q, fnow, qnew, hh);
+        fnow = f[++fi];
+      }
+      q = qnew;
+      if (hh != 0.0) h[hi++] = hh;
+    }
+  }
+  while (ei < elen) {
+    two_sum(q, enow, qnew, hh);
+    enow = e[++ei];
+    q = qnew;
+    if (hh != 0.0) h[hi++] = hh;
+  }
+  while (fi < flen) {
+    two_sum(q, fnow, qnew, hh);
+    fnow = f[++fi];
+    q = qnew;
+    if (hh != 0.0) h[hi++] = hh;
+  }
+  if (q != 0.0 || hi == 0) h[hi++] = q;
+  return hi;
+}
+
+static double estimate(int elen, const double* e) {
+  double q = e[0];
+  for (int i = 1; i < elen; i++) q += e[i];
+  return q;
+}
+
+
+/* **************************************** */
+/* the slow path of orient2d: refines the determinant until its sign is
+   certain. detsum bounds the magnitude of the two products */
+__attribute__((noinline))
+static double orient2d_adapt(fpoint2d a, fpoint2d b, fpoint2d c, double detsum) {
+  exact_count++;
+  //one extra element each, see expansion_sum()
+  double B[5], u[5], C1[9], C2[13], D[16];
+
+  double acx = a.x - c.x, bcx = b.x - c.x;
+  double acy = a.y - c.y, bcy = b.y - c.y;
+
+  //stage B: the products exactly, the differences rounded
+  double detleft, detlefttail, detright, detrighttail;
+  two_product(acx, bcy, detleft, detlefttail);
+  two_product(acy, bcx, detright, detrighttail);
+  two_two_diff(detleft, detlefttail, detright, detrighttail, B);
+  B[4] = 0;
+  double det = estimate(4, B);
+  double errbound = CCW_ERRBOUND_B * detsum;
+  if (det >= errbound || -det >= errbound) return det;
+
+  double acxtail = two_diff_tail(a.x, c.x, acx);
+  double bcxtail = two_diff_tail(b.x, c.x, bcx);
+  double acytail = two_diff_tail(a.y, c.y, acy);
+  double bcytail = two_diff_tail(b.y, c.y, bcy);
+  if (acxtail == 0.0 && acytail == 0.0 && bcxtail == 0.0 && bcytail == 0.0) return det;
+
+  //stage C: a first-order correction for the rounding of the differences
+  errbound = CCW_ERRBOUND_C * detsum + RESULT_ERRBOUND * fabs(det);
+  det += (acx * bcytail + bcy * acxtail) - (acy * bcxtail + bcx * acytail);
+  if (det >= errbound || -det >= errbound) return det;
+
+  //stage D: everything exactly
+  double s1, s0, t1, t0;
+  two_product(acxtail, bcy, s1, s0);
+  two_product(acytail, bcx, t1, t0);
+  two_two_diff(s1, s0, t1, t0, u);
+  u[4] = 0;
+  int c1len = expansion_sum(4, B, 4, u, C1);
+  C1[c1len] = 0;
+
+  two_product(acx, bcytail, s1, s0);
+  two_product(acy, bcxtail, t1, t0);
+  two_two_diff(s1, s0, t1, t0, u);
+  int c2len = expansion_sum(c1len, C1, 4, u, C2);
+  C2[c2len] = 0;
+
+  two_product(acxtail, bcytail, s1, s0);
+  two_product(acytail, bcxtail, t1, t0);
+  two_two_diff(s1, s0, t1, t0, u);
+  int dlen = expansion_sum(c2len, C2, 4, u, D);
+  return D[dlen - 1];
+}
+
+double orient2d(fpoint2d a, fpoint2d b, fpoint2d c) {
+  double detleft = (a.x - c.x) * (b.y - c.y);
+  double detright = (a.y - c.y) * (b.x - c.x);
+  double det = detleft - detright;
+  //Shewchuk returns early when the products have different signs (no
+  //cancellation); the bound below always holds then too, and testing
+  //only it keeps the fast path free of unpredictable branches
+  double detsum = fabs(detleft) + fabs(detright);
+  if (fabs(det) >= CCW_ERRBOUND_A * detsum) return det;
+  return orient2d_adapt(a, b, c, detsum);
+}
+
+long orient2d_exact_count() {
+  return exact_count;
+}
+
+
+/* **************************************** */
+int collinear(fpoint2d p, fpoint2d q, fpoint2d r) {
+  return orient2d(p, q, r) == 0;
+}
+
+int left_strictly(fpoint2d a, fpoint2d b, fpoint2d c) {
+  return orient2d(a, b, c) > 0;
+}
+
+int left_on(fpoint2d a, fpoint2d b, fpoint2d c) {
+  return orient2d(a, b, c) >= 0;
+}
+
+
+/* **************************************** */
+static inline int same_point(fpoint2d a, fpoint2d b) {
+  return a.x == b.x && a.y == b.y;
+}
+
+/*
+  radial order around the bottom point p0, as in geom.cpp. points
+  collinear with p0 are on the same ray (all points are above p0 or
+  left of it), and are ordered going out along it by comparing their
+  coordinates, which needs no arithmetic: up the ray if it is not
+  horizontal, left along it if it is. copies of p0 go first
+*/
+struct fradial_less {
+  fpoint2d p0;
+  bool operator()(const fpoint2d& a, const fpoint2d& b) const {
+    double o = orient2d(p0, a, b);
+    if (o != 0) return o > 0;
+    return a.y < b.y || (a.y == b.y && a.x > b.x);
+  }
+};
+
+/* the filter of graham_scan_inplace(), see geom.cpp */
+static int delete_middle_points_inplace(fpoint2d* pts, int n) {
+  int i_xmax = 0, i_xmin = 0, i_ymax = 0, i_ymin = 0;
+  for (int i = 1; i < n; i++) {
+    if (pts[i].x > pts[i_xmax].x) i_xmax = i;
+    if (pts[i].x < pts[i_xmin].x) i_xmin = i;
+    if (pts[i].y > pts[i_ymax].y) i_ymax = i;
+    if (pts[i].y < pts[i_ymin].y) i_ymin = i;
+  }
+  fpoint2d quad[4] = {pts[i_xmax], pts[i_ymax], pts[i_xmin], pts[i_ymin]};
+
+  int k = 0;
+  for (int i = 0; i < n; i++) {
+    fpoint2d p = pts[i];
+    for (int j = 0; j < 4; j++) {
+      if (!left_on(quad[j], quad[(j + 1) % 4], p)) {
+        pts[k++] = p;
+        break;
+      }
+    }
+  }
+  for (int j = 0; j < 4; j++) {
+    int seen = 0;
+    for (int l = 0; l < j; l++) {
+      if (same_point(quad[l], quad[j])) seen = 1;
+    }
+    if (!seen) pts[k++] = quad[j];
+  }
+  return k;
+}
+
+int graham_scan_inplace(fpoint2d* pts, int n) {
+  if (n == 0) return 0;
+  HRT_SCOPE("graham_scan_inplace(double)");
+
+  int k;
+  {
+    HRT_SCOPE("filter");
+    k = delete_middle_points_inplace(pts, n);
+  }
+
+  {
+    HRT_SCOPE("sort");
+    int i0 = 0;
+    for (int i = 1; i < k; i++) {
+      if (pts[i].y < pts[i0].y || (pts[i].y == pts[i0].y && pts[i].x > pts[i0].x)) i0 = i;
+    }
+    swap(pts[0], pts[i0]);
+    fradial_less less;
+    less.p0 = pts[0];
+    sort(pts + 1, pts + k, less);
+  }
+
+  HRT_SCOPE("scan");
+  int top = 1;
+  for (int i = 1; i < k; i++) {
+    while (top >= 2 && !left_strictly(pts[top-2], pts[top-1], pts[i])) {
+      top--;
+    }
+    if (top == 1 && same_point(pts[i], pts[0])) continue;
+    pts[top++] = pts[i];
+  }
+  while (top > 2 && !left_strictly(pts[top-2], pts[top-1], pts[0])) {
+    top--;
+  }
+  return top;
+}
+
+int graham_scan_inplace(vector<fpoint2d>& pts) {
+  int h = graham_scan_inplace(pts.data(), pts.size());
+  pts.resize(h);
+  return h;
+}
+
+void graham_scan(const vector<fpoint2d>& pts, vector<fpoint2d>& hull) {
+  hull = pts;
+  graham_scan_inplace(hull);
+}
@@ -0,0 +1,60 @@
+#ifndef __geomf_h
+#define __geomf_h
+
+#include "geom.h"
+
+#include <vector>
+
+using namespace std;
+
+
+/*
+  points with double coordinates, and robust predicates on them.
+
+  orient2d() returns the sign of the orientation determinant exactly,
+  for any finite doubles, using Shewchuk's adaptive predicate: the
+  determinant is first computed in plain double with an error bound,
+  and only if the bound does not settle the sign is it refined with
+  exact expansion arithmetic (in up to three stages). for inputs that
+  are not nearly degenerate the cost is a handful of flops more than
+  the naive formula.
+
+  this file must not be compiled with -ffast-math or with floating
+  point contraction (fused multiply-add), which break the exact error
+  analysis; the Makefile builds it with -ffp-contract=off.
+*/
+
+
+typedef struct _fpoint2d {
+  double x, y;
+} fpoint2d;
+
+
+/* returns a positive value if c is left of ab, negative if c is right of
+   ab, and 0 if a,b,c are collinear. the sign is exact; the value is an
+   approximation of twice the signed area of abc */
+double orient2d(fpoint2d a, fpoint2d b, fpoint2d c);
+
+/* the predicates of geom.h, for double points; all exact */
+int collinear(fpoint2d p, fpoint2d q, fpoint2d r);
+int left_strictly(fpoint2d a, fpoint2d b, fpoint2d c);
+int left_on(fpoint2d a, fpoint2d b, fpoint2d c);
+
+/* how many orient2d() calls were not decided by the fast filter, since
+   the program started */
+long orient2d_exact_count();
+
+/*
+  the in-place graham scan of geom.h, on double points: returns h and
+  leaves the hull in pts[0..h), CCW starting at the bottom point
+  (rightmost if tied), with no three collinear vertices. the vector
+  version shrinks pts to h points
+*/
+int graham_scan_inplace(fpoint2d* pts, int n);
+int graham_scan_inplace(vector<fpoint2d>& pts);
+
+/* computes the hull of pts into hull; pts is not changed */
+void graham_scan(const vector<fpoint2d>& pts, vector<fpoint2d>& hull);
+
+
+#endif
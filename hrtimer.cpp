@@ -0,0 +1,421 @@
+/*
+  hrtimer: nested, named timing scopes. See hrtimer.h.
+*/
+
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <assert.h>
+
+#ifdef __APPLE__
+#include <malloc/malloc.h>
+#define usable_size malloc_size
+#else
+#include <malloc.h>
+#define usable_size malloc_usable_size
+#endif
+
+#include <new>
+#include <atomic>
+#include <algorithm>
+
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "hrtimer.h"
+#include "rtimer.h"
+
+#ifndef CLOCK_MONOTONIC_RAW
+#define CLOCK_MONOTONIC_RAW CLOCK_MONOTONIC
+#endif
+
+
+static hrt_node root_node = {"", NULL};
+static hrt_node* current = &root_node;
+static int hrt_options = 0;
+//set on the one thread whose scopes are recorded
+static thread_local int scopes_on = 0;
+
+/* the perf event group; the first counter is the group leader */
+static int perf_fds[HRT_NCOUNTERS] = {-1, -1, -1, -1};
+
+
+/* ****************************** */
+/* the memory accounting. the global operator new and delete below
+   count into these while HRT_MEMORY is on, from every thread, so they
+   are atomic. sizes are what malloc actually gave (usable_size), so an
+   allocation and its free count the same whatever the caller says */
+static atomic<int> mem_on(0);
+static atomic<long long> mem_allocs(0), mem_bytes(0);
+//live bytes since the accounting started (not since the program did),
+//and their peak since the innermost open scope started
+static atomic<long long> mem_live(0), mem_peak(0);
+
+static void count_alloc(void* p) {
+  long long size = usable_size(p);
+  mem_allocs.fetch_add(1, memory_order_relaxed);
+  mem_bytes.fetch_add(size, memory_order_relaxed);
+  long long live = mem_live.fetch_add(size, memory_order_relaxed) + size;
+  long long peak = mem_peak.load(memory_order_relaxed);
+  while (live > peak && !mem_peak.compare_exchange_weak(peak, live, memory_order_relaxed)) {}
+}
+
+static inline void* counted_new(size_t size) {
+  void* p = malloc(size ? size : 1);
+  if (!p) throw bad_alloc();
+  if (mem_on.load(memory_order_relaxed)) count_alloc(p);
+  return p;
+}
+
+static inline void counted_delete(void* p) {
+  if (p && mem_on.load(memory_order_relaxed)) {
+    mem_live.fetch_sub(usable_size(p), memory_order_relaxed);
+  }
+  free(p);
+}
+
+//the nothrow and aligned forms are left to the library, which calls
+//these (or does its own, matched, aligned allocation)
+void* operator new(size_t size) { return counted_new(size); }
+void* operator new[](size_t size) { return counted_new(size); }
+void operator delete(void* p) noexcept { counted_delete(p); }
+void operator delete[](void* p) noexcept { counted_delete(p); }
+void operator delete(void* p, size_t) noexcept { counted_delete(p); }
+void operator delete[](void* p, size_t) noexcept { counted_delete(p); }
+
+
+/* ****************************** */
+static double wall_nsec() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static unsigned long long read_ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+
+/* ****************************** */
+#ifdef __linux__
+static int perf_open(unsigned int type, unsigned long long config, int group) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.disabled = (group == -1);
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP;
+  return syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+}
+#endif
+
+/* opens the counters; returns 0 if they are not available */
+static int perf_start() {
+#ifdef __linux__
+  if (perf_fds[0] >= 0) return 1;
+  unsigned long long configs[HRT_NCOUNTERS] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+  for (int i = 0; i < HRT_NCOUNTERS; i++) {
+    perf_fds[i] = perf_open(PERF_TYPE_HARDWARE, configs[i], (i == 0) ? -1 : perf_fds[0]);
+    if (perf_fds[i] < 0) {
+      perror("hrtimer: perf_event_open");
+      for (int j = 0; j < i; j++) {
+        close(perf_fds[j]);
+        perf_fds[j] = -1;
+      }
+      return 0;
+    }
+  }
+  ioctl(perf_fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(perf_fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  return 1;
+#else
+  fprintf(stderr, "hrtimer: hardware counters are only supported on Linux\n");
+  return 0;
+#endif
+}
+
+static void perf_stop() {
+  for (int i = 0; i < HRT_NCOUNTERS; i++) {
+    if (perf_fds[i] >= 0) close(perf_fds[i]);
+    perf_fds[i] = -1;
+  }
+}
+
+static void perf_read(long long* counters) {
+  //group read format: the number of counters, then their values
+  unsigned long long buf[1 + HRT_NCOUNTERS];
+  if (read(perf_fds[0], buf, sizeof(buf)) != (ssize_t)sizeof(buf)) {
+    memset(counters, 0, HRT_NCOUNTERS * sizeof(long long));
+    return;
+  }
+  for (int i = 0; i < HRT_NCOUNTERS; i++) counters[i] = buf[1 + i];
+}
+
+
+/* ****************************** */
+static void take_stamp(hrt_stamp* s) {
+  if (hrt_options & HRT_RUSAGE) {
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) < 0) {
+      perror("rusage");
+      exit(1);
+    }
+    s->user_usec = ru.ru_utime.tv_sec * 1e6 + ru.ru_utime.tv_usec;
+    s->sys_usec = ru.ru_stime.tv_sec * 1e6 + ru.ru_stime.tv_usec;
+  }
+  if (hrt_options & HRT_COUNTERS) perf_read(s->counters);
+  if (hrt_options & HRT_MEMORY) {
+    s->allocs = mem_allocs.load(memory_order_relaxed);
+    s->alloc_bytes = mem_bytes.load(memory_order_relaxed);
+    s->live_bytes = mem_live.load(memory_order_relaxed);
+  }
+  s->ticks = read_ticks();
+  s->wall_nsec = wall_nsec();
+}
+
+
+/* ****************************** */
+/* returns the child of parent with the given name, creating it if needed */
+static hrt_node* get_child(hrt_node* parent, const char* name) {
+  for (int i = 0; i < (int)parent->children.size(); i++) {
+    if (parent->children[i]->name == name) return parent->children[i];
+  }
+  //the tree is not what is being measured
+  int on = mem_on.exchange(0);
+  hrt_node* n = new hrt_node();
+  n->name = name;
+  n->parent = parent;
+  n->count = 0;
+  n->tw_nsec = n->tu_usec = n->ts_usec = 0;
+  n->ticks = 0;
+  memset(n->counters, 0, sizeof(n->counters));
+  n->allocs = n->alloc_bytes = n->peak_bytes = 0;
+  parent->children.push_back(n);
+  mem_on.store(on);
+  return n;
+}
+
+
+/* ****************************** */
+void hrt_enable(int on) {
+  scopes_on = on;
+}
+
+HrtScope::HrtScope(const char* name) {
+  node = NULL;
+  if (!scopes_on) return;
+  node = get_child(current, name);
+  current = node;
+  take_stamp(&start);
+  //the peak of this scope starts from what is live now; the enclosing
+  //scope gets it back, raised to this one's, when this one ends
+  if (hrt_options & HRT_MEMORY) start.outer_peak = mem_peak.exchange(start.live_bytes);
+}
+
+HrtScope::~HrtScope() {
+  if (!node) return;
+  hrt_stamp stop;
+  take_stamp(&stop);
+  node->count++;
+  node->tw_nsec += stop.wall_nsec - start.wall_nsec;
+  node->ticks += stop.ticks - start.ticks;
+  if (hrt_options & HRT_RUSAGE) {
+    node->tu_usec += stop.user_usec - start.user_usec;
+    node->ts_usec += stop.sys_usec - start.sys_usec;
+  }
+  if (hrt_options & HRT_COUNTERS) {
+    for (int i = 0; i < HRT_NCOUNTERS; i++) {
+      node->counters[i] += stop.counters[i] - start.counters[i];
+    }
+  }
+  if (hrt_options & HRT_MEMORY) {
+    node->allocs += stop.allocs - start.allocs;
+    node->alloc_bytes += stop.alloc_bytes - start.alloc_bytes;
+    long long peak = mem_peak.load(memory_order_relaxed);
+    node->peak_bytes = max(node->peak_bytes, peak - start.live_bytes);
+    mem_peak.store(max(peak, start.outer_peak), memory_order_relaxed);
+  }
+  current = node->parent;
+}
+
+
+/* ****************************** */
+int hrt_set_options(int options) {
+  if (options & HRT_COUNTERS) {
+    if (!perf_start()) options &= ~HRT_COUNTERS;
+  } else {
+    perf_stop();
+  }
+  if (options & HRT_MEMORY) mem_peak.store(mem_live.load());
+  mem_on.store((options & HRT_MEMORY) != 0);
+  hrt_options = options;
+  return hrt_options;
+}
+
+
+/* ****************************** */
+hrt_node* hrt_root() {
+  return &root_node;
+}
+
+
+/* ****************************** */
+hrt_node* hrt_find(const char* path) {
+  hrt_node* n = &root_node;
+  const char* p = path;
+  while (*p) {
+    const char* slash = strchr(p, '/');
+    int len = slash ? slash - p : strlen(p);
+    hrt_node* next = NULL;
+    for (int i = 0; i < (int)n->children.size(); i++) {
+      if (n->children[i]->name.compare(0, string::npos, p, len) == 0) {
+        next = n->children[i];
+        break;
+      }
+    }
+    if (!next) return NULL;
+    n = next;
+    p += len;
+    if (*p == '/') p++;
+  }
+  return n;
+}
+
+
+/* ****************************** */
+static void free_children(hrt_node* n) {
+  for (int i = 0; i < (int)n->children.size(); i++) {
+    free_children(n->children[i]);
+    delete n->children[i];
+  }
+  n->children.clear();
+}
+
+void hrt_reset() {
+  assert(current == &root_node);
+  int on = mem_on.exchange(0);
+  free_children(&root_node);
+  mem_on.store(on);
+}
+
+
+/* ****************************** */
+char* hrt_sprint(char* buf, const hrt_node* n) {
+  //same format as rt_sprint: let Rtimer print the totals
+  Rtimer rt;
+  rt_zero(rt);
+  rt.tw_usec = n->tw_nsec / 1000;
+  rt.tu_usec = n->tu_usec;
+  rt.ts_usec = n->ts_usec;
+  return rt_sprint_total(buf, rt);
+}
+
+
+/* ****************************** */
+char* hrt_sprint_bytes(char* buf, long long bytes) {
+  const char* units[] = {"B", "KB", "MB", "GB"};
+  double b = bytes;
+  int u = 0;
+  while (u < 3 && (b >= 1024 || b <= -1024)) {
+    b /= 1024;
+    u++;
+  }
+  if (u == 0) sprintf(buf, "%lld B", bytes);
+  else sprintf(buf, "%.1f %s", b, units[u]);
+  return buf;
+}
+
+
+/* ****************************** */
+static void print_node(FILE* f, const hrt_node* n, int depth) {
+  char buf[256];
+  fprintf(f, "%*s%-*s %8ld %s %12.0f ns/run", 2*depth, "", 24 - 2*depth, n->name.c_str(),
+          n->count, hrt_sprint(buf, n), n->count ? n->tw_nsec / n->count : 0.0);
+  if (hrt_options & HRT_COUNTERS) {
+    double ipc = n->counters[HRT_CYCLES] ?
+      (double)n->counters[HRT_INSTRUCTIONS] / n->counters[HRT_CYCLES] : 0;
+    fprintf(f, "  cycles=%lld instr=%lld ipc=%.2f llc-miss=%lld br-miss=%lld",
+            n->counters[HRT_CYCLES], n->counters[HRT_INSTRUCTIONS], ipc,
+            n->counters[HRT_LLC_MISSES], n->counters[HRT_BRANCH_MISSES]);
+  }
+  if (hrt_options & HRT_MEMORY) {
+    char bytes[32], peak[32];
+    fprintf(f, "  allocs=%lld alloc=%s peak=%s", n->allocs,
+            hrt_sprint_bytes(bytes, n->alloc_bytes), hrt_sprint_bytes(peak, n->peak_bytes));
+  }
+  fprintf(f, "\n");
+  for (int i = 0; i < (int)n->children.size(); i++) {
+    print_node(f, n->children[i], depth + 1);
+  }
+}
+
+void hrt_print_tree(FILE* f) {
+  for (int i = 0; i < (int)root_node.children.size(); i++) {
+    print_node(f, root_node.children[i], 0);
+  }
+}
+
+
+/* ****************************** */
+static void write_node(FILE* f, const hrt_node* n, int depth) {
+  fprintf(f, "%*s{\"name\": \"%s\", \"count\": %ld, \"wall_ns\": %.0f, \"user_us\": %.0f, "
+          "\"sys_us\": %.0f, \"ticks\": %llu", 2*depth, "", n->name.c_str(), n->count,
+          n->tw_nsec, n->tu_usec, n->ts_usec, n->ticks);
+  if (hrt_options & HRT_COUNTERS) {
+    fprintf(f, ", \"cycles\": %lld, \"instructions\": %lld, \"llc_misses\": %lld, "
+            "\"branch_misses\": %lld", n->counters[HRT_CYCLES], n->counters[HRT_INSTRUCTIONS],
+            n->counters[HRT_LLC_MISSES], n->counters[HRT_BRANCH_MISSES]);
+  }
+  if (hrt_options & HRT_MEMORY) {
+    fprintf(f, ", \"allocs\": %lld, \"alloc_bytes\": %lld, \"peak_bytes\": %lld",
+            n->allocs, n->alloc_bytes, n->peak_bytes);
+  }
+  fprintf(f, ", \"children\": [");
+  for (int i = 0; i < (int)n->children.size(); i++) {
+    fprintf(f, "%s\n", i ? "," : "");
+    write_node(f, n->children[i], depth + 1);
+  }
+  if (n->children.size()) fprintf(f, "\n%*s", 2*depth, "");
+  fprintf(f, "]}");
+}
+
+int hrt_write_json(FILE* f) {
+  fprintf(f, "[");
+  for (int i = 0; i < (int)root_node.children.size(); i++) {
+    fprintf(f, "%s\n", i ? "," : "");
+    write_node(f, root_node.children[i], 1);
+  }
+  fprintf(f, "\n]\n");
+  return 1;
+}
+
+int hrt_write_json(const char* path) {
+  FILE* f = fopen(path, "w");
+  if (!f) {
+    perror(path);
+    return 0;
+  }
+  hrt_write_json(f);
+  fclose(f);
+  return 1;
+}
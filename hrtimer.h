@@ -0,0 +1,138 @@
+/*
+  hrtimer: nested, named timing scopes.
+
+  A successor to Rtimer for timing inside the hull code. Wall time is
+  read with clock_gettime(CLOCK_MONOTONIC_RAW) (no syscall on Linux), plus
+  the time stamp counter on x86. User/system time (getrusage) and
+  hardware counters (perf_event_open: cycles, instructions, LLC misses,
+  branch misses) are optional, since they cost syscalls. So is the
+  memory accounting: with HRT_MEMORY, every scope also counts the
+  allocations made while it is open, the bytes they asked for, and the
+  peak of the live heap above what was live when the scope started.
+
+  Scopes nest: every HRT_SCOPE("name") opened while another scope is
+  open becomes its child, and repeated scopes with the same name under
+  the same parent are accumulated into one node. The result is a tree
+  that can be printed (in the rt_sprint format) or exported as json.
+
+  usage:
+    hrt_enable(1);
+    {
+      HRT_SCOPE("hull");
+      ...
+      { HRT_SCOPE("sort"); sort_points(pts); }
+    }
+    hrt_print_tree(stdout);
+
+  Scopes are opt-in, and belong to one thread: HRT_SCOPE does nothing
+  (but check a thread-local flag) until hrt_enable(1) is called, and
+  then only on the thread that called it. So the library routines that
+  open scopes (graham_scan() and friends) stay safe to call from
+  several threads, and cost nothing measurable when nobody is timing.
+  The memory accounting is done in the global operator new and delete,
+  so it counts the allocations of all threads while a scope is open
+  (and not malloc() calls, or the mmap()ed chunks of a hull_arena).
+*/
+
+#ifndef HRTIMER_H
+#define HRTIMER_H
+
+#include <stdio.h>
+
+#include <vector>
+#include <string>
+
+using namespace std;
+
+
+/* options for hrt_set_options(), or-ed together */
+#define HRT_RUSAGE   1  /* measure user and system time with getrusage */
+#define HRT_COUNTERS 2  /* read hardware counters with perf_event_open (Linux) */
+#define HRT_MEMORY   4  /* count allocations, bytes and peak live bytes */
+
+/* the hardware counters, in the order they are stored */
+#define HRT_CYCLES       0
+#define HRT_INSTRUCTIONS 1
+#define HRT_LLC_MISSES   2
+#define HRT_BRANCH_MISSES 3
+#define HRT_NCOUNTERS    4
+
+
+/* one node of the scope tree, with the totals over all its runs */
+typedef struct _hrt_node {
+  string name;
+  struct _hrt_node* parent;
+  vector<struct _hrt_node*> children;
+
+  long count;            /* number of times the scope ran */
+  double tw_nsec;        /* total wall time in nanoseconds */
+  double tu_usec;        /* total user time, if HRT_RUSAGE */
+  double ts_usec;        /* total system time, if HRT_RUSAGE */
+  unsigned long long ticks; /* total time stamp counter ticks (x86 only) */
+  long long counters[HRT_NCOUNTERS]; /* totals, if HRT_COUNTERS */
+  long long allocs;      /* total allocations, if HRT_MEMORY */
+  long long alloc_bytes; /* total bytes allocated, if HRT_MEMORY */
+  long long peak_bytes;  /* most live bytes above the start, over all runs */
+} hrt_node;
+
+
+/* the state of a running scope */
+typedef struct _hrt_stamp {
+  double wall_nsec;
+  unsigned long long ticks;
+  double user_usec, sys_usec;
+  long long counters[HRT_NCOUNTERS];
+  long long allocs, alloc_bytes, live_bytes;
+  long long outer_peak;  /* the peak of the enclosing scope, saved */
+} hrt_stamp;
+
+
+/* a timing scope: starts on construction, stops and accumulates into
+   its node of the tree on destruction */
+class HrtScope {
+public:
+  HrtScope(const char* name);
+  ~HrtScope();
+private:
+  hrt_node* node;   //NULL if this thread does not record scopes
+  hrt_stamp start;
+};
+
+#define HRT_CONCAT2(a, b) a##b
+#define HRT_CONCAT(a, b) HRT_CONCAT2(a, b)
+#define HRT_SCOPE(name) HrtScope HRT_CONCAT(hrt_scope_, __LINE__)(name)
+
+
+/* records the scopes opened by the calling thread from now on (on=1),
+   or stops (on=0). one thread at a time may have them on */
+void hrt_enable(int on);
+
+/* sets the HRT_* options. returns the options actually in effect:
+   HRT_COUNTERS is dropped if the counters cannot be opened */
+int hrt_set_options(int options);
+
+/* the root of the scope tree; its children are the outermost scopes */
+hrt_node* hrt_root();
+
+/* finds a node by its path from the root, e.g. "graham_scan/sort";
+   returns NULL if there is no such node */
+hrt_node* hrt_find(const char* path);
+
+/* clears the tree. must not be called while a scope is open */
+void hrt_reset();
+
+/* prints the totals of node n in the rt_sprint() format:
+   [user (%) system (%) wall cpu%], times in seconds */
+char* hrt_sprint(char* buf, const hrt_node* n);
+
+/* prints a byte count in buf, as B, KB, MB or GB */
+char* hrt_sprint_bytes(char* buf, long long bytes);
+
+/* prints the tree, one indented line per node */
+void hrt_print_tree(FILE* f);
+
+/* writes the tree as json; returns 1 on success */
+int hrt_write_json(FILE* f);
+int hrt_write_json(const char* path);
+
+#endif /* HRTIMER_H */
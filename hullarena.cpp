@@ -0,0 +1,165 @@
+#include "hullarena.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <pthread.h>
+
+#include <algorithm>
+#include <new>
+
+//chunks are multiples of, and aligned to, the size of a huge page
+static const size_t HUGE_PAGE = 2 << 20;
+static const size_t PAGE = 4096;
+
+
+/* ****************************** */
+typedef struct _touch_job {
+  char* base;
+  size_t size;
+} touch_job;
+
+static void* touch_pages(void* arg) {
+  touch_job* job = (touch_job*)arg;
+  for (size_t i = 0; i < job->size; i += PAGE) job->base[i] = 0;
+  return NULL;
+}
+
+/* writes every page of [base, base + size) so it gets faulted in now,
+   each of nthreads threads taking one contiguous slice */
+static void first_touch(char* base, size_t size, int nthreads) {
+  size_t npages = size / PAGE;
+  if (nthreads > (long)npages) nthreads = npages;
+  if (nthreads <= 1) {
+    touch_job job = {base, size};
+    touch_pages(&job);
+    return;
+  }
+  vector<pthread_t> threads(nthreads);
+  vector<touch_job> jobs(nthreads);
+  for (int t = 0; t < nthreads; t++) {
+    size_t p0 = npages * t / nthreads, p1 = npages * (t + 1) / nthreads;
+    jobs[t].base = base + p0 * PAGE;
+    jobs[t].size = (p1 - p0) * PAGE;
+    if (pthread_create(&threads[t], NULL, touch_pages, &jobs[t]) != 0) {
+      //no thread: touch that slice here
+      touch_pages(&jobs[t]);
+      threads[t] = pthread_self();
+    }
+  }
+  for (int t = 0; t < nthreads; t++) {
+    if (!pthread_equal(threads[t], pthread_self())) pthread_join(threads[t], NULL);
+  }
+}
+
+/* maps a chunk of at least size bytes, 2MB aligned */
+static hull_arena_chunk map_chunk(hull_arena* a, size_t size) {
+  size = (size + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+  //map one huge page more, and trim to an aligned range
+  size_t len = size + HUGE_PAGE;
+  char* p = (char*)mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (p == MAP_FAILED) {
+    perror("hull_arena: mmap");
+    throw bad_alloc();
+  }
+  char* base = (char*)(((uintptr_t)p + HUGE_PAGE - 1) & ~(uintptr_t)(HUGE_PAGE - 1));
+  if (base > p) munmap(p, base - p);
+  if (p + len > base + size) munmap(base + size, p + len - (base + size));
+
+#ifdef MADV_HUGEPAGE
+  //only advice: fails harmlessly if the kernel has no THP
+  if (a->flags & HULL_ARENA_HUGEPAGES) madvise(base, size, MADV_HUGEPAGE);
+#endif
+  if (a->prefault_threads > 1) first_touch(base, size, a->prefault_threads);
+
+  a->stats.maps++;
+  a->stats.reserved += size;
+  hull_arena_chunk c = {base, size};
+  return c;
+}
+
+
+/* ****************************** */
+hull_arena::hull_arena() {
+  cur = 0;
+  off = 0;
+  chunk_size = HUGE_PAGE;
+  flags = 0;
+  prefault_threads = 1;
+  memset(&stats, 0, sizeof(stats));
+}
+
+hull_arena::~hull_arena() {
+  hull_arena_release(this);
+}
+
+void* hull_arena::do_allocate(size_t bytes, size_t alignment) {
+  //the current chunk, then the ones after it (kept from before the
+  //last reset), then a new one
+  for (; cur < (int)chunks.size(); cur++, off = 0) {
+    size_t start = (off + alignment - 1) & ~(alignment - 1);
+    if (start + bytes <= chunks[cur].size) {
+      off = start + bytes;
+      stats.used += bytes;
+      stats.high_water = max(stats.high_water, stats.used);
+      return chunks[cur].base + start;
+    }
+  }
+  chunks.push_back(map_chunk(this, max(chunk_size, bytes)));
+  cur = chunks.size() - 1;
+  off = bytes;
+  stats.used += bytes;
+  stats.high_water = max(stats.high_water, stats.used);
+  return chunks[cur].base;
+}
+
+void hull_arena::do_deallocate(void* p, size_t bytes, size_t alignment) {
+  //freed all at once by hull_arena_reset()
+}
+
+bool hull_arena::do_is_equal(const pmr::memory_resource& other) const noexcept {
+  return this == &other;
+}
+
+
+/* ****************************** */
+void hull_arena_init(hull_arena* a, size_t chunk_size, int flags, int prefault_threads) {
+  hull_arena_release(a);
+  a->chunk_size = max(chunk_size, HUGE_PAGE);
+  a->flags = flags;
+  a->prefault_threads = prefault_threads;
+  memset(&a->stats, 0, sizeof(a->stats));
+}
+
+void hull_arena_reserve(hull_arena* a, size_t bytes) {
+  for (size_t i = 0; i < a->chunks.size(); i++) {
+    if (a->chunks[i].size >= bytes) return;
+  }
+  hull_arena_chunk c = map_chunk(a, max(a->chunk_size, bytes));
+  if (a->stats.used == 0) {
+    //nothing handed out yet: use it first
+    a->chunks.insert(a->chunks.begin(), c);
+    a->cur = 0;
+    a->off = 0;
+  } else {
+    a->chunks.push_back(c);
+  }
+}
+
+void hull_arena_reset(hull_arena* a) {
+  a->cur = 0;
+  a->off = 0;
+  a->stats.used = 0;
+}
+
+void hull_arena_release(hull_arena* a) {
+  for (size_t i = 0; i < a->chunks.size(); i++) {
+    munmap(a->chunks[i].base, a->chunks[i].size);
+  }
+  a->chunks.clear();
+  a->cur = 0;
+  a->off = 0;
+  a->stats.used = 0;
+  a->stats.reserved = 0;
+}
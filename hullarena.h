@@ -0,0 +1,89 @@
+#ifndef __hullarena_h
+#define __hullarena_h
+
+#include <stddef.h>
+
+#include <vector>
+#include <memory_resource>
+
+using namespace std;
+
+
+/*
+  an arena for the scratch buffers of the hull pipeline, usable as a
+  std::pmr::memory_resource (see graham_scan() with a memory resource
+  in geom.h).
+
+  memory is handed out by bumping a pointer through large chunks, and
+  freeing is a no-op: everything goes at once with hull_arena_reset(),
+  which keeps the chunks for the next call. once the arena has grown to
+  what a call needs, repeated calls allocate nothing, take no locks and
+  fault in no new pages.
+
+  the chunks are mmap()ed in multiples of 2MB, 2MB aligned, and with
+  HULL_ARENA_HUGEPAGES they are madvise()d to be backed by transparent
+  huge pages (when the kernel has them enabled, in "always" or
+  "madvise" mode), which cuts page faults and TLB misses on large
+  inputs by 512x. with prefault_threads > 1, every new chunk is touched
+  by that many threads, each writing its own contiguous slice: on a
+  NUMA machine a page is placed on the node of the thread that first
+  touches it, so a chunk is spread like the threads that will work on
+  it, instead of all landing on the node of the thread that allocated
+  it.
+*/
+
+#define HULL_ARENA_HUGEPAGES  1
+
+typedef struct _hull_arena_chunk {
+  char* base;
+  size_t size;
+} hull_arena_chunk;
+
+typedef struct _hull_arena_stats {
+  long maps;          //chunks mmap()ed so far
+  size_t reserved;    //bytes in the chunks
+  size_t used;        //bytes handed out since the last reset
+  size_t high_water;  //the most bytes used between two resets
+} hull_arena_stats;
+
+struct hull_arena : public pmr::memory_resource {
+  vector<hull_arena_chunk> chunks;
+  int cur;            //chunk being bumped through
+  size_t off;         //offset of the free space in it
+  size_t chunk_size;  //size of new chunks, unless an allocation needs more
+  int flags;
+  int prefault_threads;
+  hull_arena_stats stats;
+
+  hull_arena();
+  ~hull_arena();
+  //owns its chunks
+  hull_arena(const hull_arena&) = delete;
+  hull_arena& operator=(const hull_arena&) = delete;
+
+protected:
+  void* do_allocate(size_t bytes, size_t alignment);
+  void do_deallocate(void* p, size_t bytes, size_t alignment);
+  bool do_is_equal(const pmr::memory_resource& other) const noexcept;
+};
+
+
+/*
+  sets up an empty arena that maps chunks of at least chunk_size bytes
+  (rounded up to 2MB). flags is 0 or HULL_ARENA_HUGEPAGES; new chunks
+  are first touched by prefault_threads threads if that is more than 1
+*/
+void hull_arena_init(hull_arena* a, size_t chunk_size, int flags, int prefault_threads);
+
+/* makes sure the arena has bytes of room without mapping anything
+   later, e.g. before timing or before the first call */
+void hull_arena_reserve(hull_arena* a, size_t bytes);
+
+/* frees everything handed out; the chunks are kept */
+void hull_arena_reset(hull_arena* a);
+
+/* unmaps all the chunks */
+void hull_arena_release(hull_arena* a);
+
+
+#endif
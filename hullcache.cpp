@@ -0,0 +1,149 @@
+#include "hullcache.h"
+
+#include <string.h>
+#include <stdint.h>
+
+
+/* ****************************** */
+/* the hash: the points are read as 64-bit words and mixed into four
+   independent lanes, xxhash style, so that the multiplies of
+   consecutive words overlap and hashing runs close to memory speed.
+   the two halves of the key come from combining the lanes in two
+   different ways */
+
+static const uint64_t P1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t P2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t P3 = 0x165667B19E3779F9ULL;
+static const uint64_t P4 = 0x85EBCA77C2B2AE63ULL;
+
+static inline uint64_t rotl(uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t round64(uint64_t acc, uint64_t w) {
+  acc += w * P2;
+  acc = rotl(acc, 31);
+  return acc * P1;
+}
+
+static inline uint64_t avalanche(uint64_t h) {
+  h ^= h >> 33;
+  h *= P2;
+  h ^= h >> 29;
+  h *= P3;
+  h ^= h >> 32;
+  return h;
+}
+
+hull_key hull_cache_key(const point2d* pts, long n, int engine, long param) {
+  //a point2d is two ints, one 64-bit word
+  const unsigned char* p = (const unsigned char*)pts;
+  uint64_t v1 = P1 + P2, v2 = P2, v3 = 0, v4 = -P1;
+  long i = 0;
+  for (; i + 4 <= n; i += 4) {
+    uint64_t w[4];
+    memcpy(w, p + i * sizeof(point2d), sizeof(w));
+    v1 = round64(v1, w[0]);
+    v2 = round64(v2, w[1]);
+    v3 = round64(v3, w[2]);
+    v4 = round64(v4, w[3]);
+  }
+  for (; i < n; i++) {
+    uint64_t w;
+    memcpy(&w, p + i * sizeof(point2d), sizeof(w));
+    v1 = round64(v1, w);
+    v1 = rotl(v1, 27);
+  }
+
+  hull_key key;
+  key.h1 = avalanche(rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18) + n * P4);
+  key.h2 = avalanche((v1 * P3) ^ rotl(v2, 23) ^ (v3 * P4) ^ rotl(v4, 41) ^ (n * P1));
+  key.n = n;
+  key.engine = engine;
+  key.param = param;
+  return key;
+}
+
+
+/* ****************************** */
+void hull_cache_init(hull_cache* c, size_t budget) {
+  c->lru.clear();
+  c->index.clear();
+  memset(&c->stats, 0, sizeof(c->stats));
+  c->stats.budget = budget;
+}
+
+void hull_cache_clear(hull_cache* c) {
+  c->lru.clear();
+  c->index.clear();
+  c->stats.entries = 0;
+  c->stats.bytes = 0;
+}
+
+/* evicts the least recently used entry */
+static void evict_one(hull_cache* c) {
+  hull_cache_entry& e = c->lru.back();
+  c->stats.bytes -= e.bytes;
+  c->stats.entries--;
+  c->stats.evictions++;
+  c->index.erase(e.key);
+  c->lru.pop_back();
+}
+
+
+/* ****************************** */
+int hull_cache_get(hull_cache* c, const hull_key& key, vector<point2d>& hull) {
+  auto it = c->index.find(key);
+  if (it == c->index.end()) {
+    c->stats.misses++;
+    return 0;
+  }
+  //move it to the front
+  c->lru.splice(c->lru.begin(), c->lru, it->second);
+  hull = it->second->hull;
+  c->stats.hits++;
+  return 1;
+}
+
+void hull_cache_put(hull_cache* c, const hull_key& key, const vector<point2d>& hull) {
+  //the hull, the list node and the index node
+  size_t bytes = hull.size() * sizeof(point2d) + sizeof(hull_cache_entry)
+    + 2 * sizeof(void*) + sizeof(hull_key) + 3 * sizeof(void*);
+  if (bytes > c->stats.budget) return;
+
+  auto it = c->index.find(key);
+  if (it != c->index.end()) {
+    c->stats.bytes -= it->second->bytes;
+    c->stats.entries--;
+    c->lru.erase(it->second);
+    c->index.erase(it);
+  }
+  while (c->stats.bytes + bytes > c->stats.budget) evict_one(c);
+
+  hull_cache_entry e;
+  e.key = key;
+  e.hull = hull;
+  e.bytes = bytes;
+  c->lru.push_front(e);
+  c->index[key] = c->lru.begin();
+  c->stats.bytes += bytes;
+  c->stats.entries++;
+}
+
+
+/* ****************************** */
+void graham_scan_cached(hull_cache* c, vector<point2d>& pts, vector<point2d>& hull) {
+  hull_key key = hull_cache_key(pts.data(), pts.size(), HULL_ENGINE_GRAHAM, 0);
+  if (hull_cache_get(c, key, hull)) return;
+  graham_scan(pts, hull);
+  hull_cache_put(c, key, hull);
+}
+
+void hull_cache_print_stats(FILE* f, const hull_cache* c) {
+  const hull_cache_stats& s = c->stats;
+  long lookups = s.hits + s.misses;
+  fprintf(f, "hull cache: %ld hits, %ld misses (%.1f%% hits), %ld evictions, "
+          "%ld entries, %lu of %lu bytes\n", s.hits, s.misses,
+          lookups ? 100.0 * s.hits / lookups : 0.0, s.evictions, s.entries,
+          (unsigned long)s.bytes, (unsigned long)s.budget);
+}
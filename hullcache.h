@@ -0,0 +1,99 @@
+#ifndef __hullcache_h
+#define __hullcache_h
+
+#include "geom.h"
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include <vector>
+#include <list>
+#include <unordered_map>
+
+using namespace std;
+
+
+/*
+  content-addressed cache of hull results.
+
+  a hull is stored under a key made of a 128-bit hash of the input
+  points, their number, the engine that computed the hull and its
+  parameter. a lookup costs one pass over the points to hash them
+  (plus copying the hull out), so a hit is about as fast as reading
+  the input once. entries are evicted least recently used first when
+  the memory they take exceeds the budget.
+
+  the hash is of the points in the order they are given: the same set
+  in a different order is a miss.
+*/
+
+
+/* engines a hull can come from; part of the key */
+#define HULL_ENGINE_GRAHAM   0   //graham_scan()
+#define HULL_ENGINE_INPLACE  1   //graham_scan_inplace()
+
+typedef struct _hull_key {
+  unsigned long long h1, h2;  //hash of the points
+  long n;                     //number of points
+  int engine;
+  long param;                 //engine parameter, 0 if it has none
+} hull_key;
+
+struct hull_key_hash {
+  size_t operator()(const hull_key& k) const { return (size_t)k.h1; }
+};
+
+struct hull_key_equal {
+  bool operator()(const hull_key& a, const hull_key& b) const {
+    return a.h1 == b.h1 && a.h2 == b.h2 && a.n == b.n
+      && a.engine == b.engine && a.param == b.param;
+  }
+};
+
+typedef struct _hull_cache_entry {
+  hull_key key;
+  vector<point2d> hull;
+  size_t bytes;   //what the entry is charged against the budget
+} hull_cache_entry;
+
+typedef struct _hull_cache_stats {
+  long hits, misses;
+  long evictions;
+  long entries;
+  size_t bytes;    //memory used by the entries
+  size_t budget;
+} hull_cache_stats;
+
+typedef struct _hull_cache {
+  list<hull_cache_entry> lru;   //most recently used first
+  unordered_map<hull_key, list<hull_cache_entry>::iterator,
+                hull_key_hash, hull_key_equal> index;
+  hull_cache_stats stats;
+} hull_cache;
+
+
+/* initializes an empty cache that keeps at most budget bytes of hulls */
+void hull_cache_init(hull_cache* c, size_t budget);
+
+/* removes all entries; the counters are kept */
+void hull_cache_clear(hull_cache* c);
+
+/* the key of the hull of pts[0..n) computed by engine with parameter param */
+hull_key hull_cache_key(const point2d* pts, long n, int engine, long param);
+
+/* if key is in the cache, copies its hull into hull and returns 1;
+   otherwise returns 0. counts a hit or a miss */
+int hull_cache_get(hull_cache* c, const hull_key& key, vector<point2d>& hull);
+
+/* stores hull under key, evicting the least recently used entries to
+   stay within the budget. a hull bigger than the budget is not stored */
+void hull_cache_put(hull_cache* c, const hull_key& key, const vector<point2d>& hull);
+
+/* graham_scan(pts, hull), answered from the cache if pts was seen before */
+void graham_scan_cached(hull_cache* c, vector<point2d>& pts, vector<point2d>& hull);
+
+/* prints the hit/miss counters and the memory used */
+void hull_cache_print_stats(FILE* f, const hull_cache* c);
+
+
+#endif
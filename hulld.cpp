@@ -0,0 +1,296 @@
+/* hulld.cpp
+
+   Resident hull service. Listens on a Unix domain socket; clients pass
+   their points in a shared memory segment and get back the indices of
+   the hull points (see hullproto.h).
+
+   A fixed pool of worker threads serves the connections, one
+   connection per worker at a time. Every worker keeps its scratch
+   buffer and the mapping of its client's segment between requests, so
+   repeated requests of similar size allocate nothing. The latency of
+   every request is recorded in a histogram, which is printed on exit
+   (SIGINT/SIGTERM) and returned to clients that ask for it.
+
+   usage: hulld [-s socket] [-w nworkers]
+*/
+
+#include "geom.h"
+#include "hullgeneric.h"
+#include "hullproto.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <vector>
+#include <deque>
+#include <string>
+using namespace std;
+
+
+/* global variables */
+
+volatile sig_atomic_t running = 1;
+
+//accepted connections waiting for a worker
+deque<int> pending;
+pthread_mutex_t pending_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t pending_cond = PTHREAD_COND_INITIALIZER;
+
+//latency of all requests served
+long latency_hist[HULLD_NBUCKETS];
+pthread_mutex_t hist_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
+/* a worker's state, kept warm between requests */
+typedef struct _worker {
+  pthread_t thread;
+  int fd;               //the connection being served, or -1
+  vector<int> idx;      //scratch for the hull indices
+  string shm_name;      //the segment currently mapped
+  void* map;
+  size_t map_len;
+  dev_t map_dev;        //identify the segment mapped, to notice a new
+  ino_t map_ino;        //one created under the same name
+} worker;
+
+
+/* ****************************** */
+static double now_usec() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+void on_signal(int sig) {
+  running = 0;
+}
+
+
+/* ****************************** */
+/* maps the segment name into w, unless it is already mapped as it is
+   now: the segment is looked up again on every request, and remapped if
+   it was resized or recreated under the same name since (the client may
+   have grown it, and an old mapping of a shrunk segment would fault).
+   returns 0 if it cannot be mapped */
+int map_segment(worker* w, const char* name) {
+  int fd = shm_open(name, O_RDWR, 0);
+  if (fd < 0) {
+    perror(name);
+    return 0;
+  }
+  struct stat st;
+  if (fstat(fd, &st) < 0) {
+    perror(name);
+    close(fd);
+    return 0;
+  }
+  if (w->map && w->shm_name == name && w->map_len == (size_t)st.st_size
+      && w->map_dev == st.st_dev && w->map_ino == st.st_ino) {
+    close(fd);
+    return 1;
+  }
+  if (w->map) {
+    munmap(w->map, w->map_len);
+    w->map = NULL;
+  }
+  void* map = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    perror("mmap segment");
+    return 0;
+  }
+  w->map = map;
+  w->map_len = st.st_size;
+  w->map_dev = st.st_dev;
+  w->map_ino = st.st_ino;
+  w->shm_name = name;
+  return 1;
+}
+
+
+/* ****************************** */
+/* answers one request */
+void handle_request(worker* w, hulld_request* req, hulld_reply* reply) {
+  memset(reply, 0, sizeof(hulld_reply));
+  if (req->magic != HULLD_MAGIC) {
+    reply->status = HULLD_EBADREQ;
+    return;
+  }
+
+  if (req->op == HULLD_OP_STATS) {
+    pthread_mutex_lock(&hist_lock);
+    memcpy(reply->hist, latency_hist, sizeof(latency_hist));
+    pthread_mutex_unlock(&hist_lock);
+    return;
+  }
+  if (req->op != HULLD_OP_HULL) {
+    reply->status = HULLD_EBADREQ;
+    return;
+  }
+
+  double t0 = now_usec();
+  req->shm_name[sizeof(req->shm_name) - 1] = '\0';
+  //hull_indices() takes an int
+  if (req->n < 0 || req->n > INT_MAX
+      || !map_segment(w, req->shm_name)
+      || w->map_len < hulld_segment_size(req->n)) {
+    reply->status = HULLD_ESHM;
+    return;
+  }
+
+  point2d* pts = (point2d*)w->map;
+  int h = hull_indices(pts, req->n, &point2d::x, &point2d::y, w->idx);
+  memcpy(hulld_segment_indices(w->map, req->n), w->idx.data(), h * sizeof(int));
+  reply->h = h;
+  reply->usec = now_usec() - t0;
+
+  pthread_mutex_lock(&hist_lock);
+  hist_add(latency_hist, reply->usec);
+  pthread_mutex_unlock(&hist_lock);
+}
+
+
+/* ****************************** */
+/* serves requests on connection fd until the client closes it */
+void serve(worker* w, int fd) {
+  hulld_request req;
+  hulld_reply reply;
+  while (running && read_full(fd, &req, sizeof(req))) {
+    handle_request(w, &req, &reply);
+    if (!write_full(fd, &reply, sizeof(reply))) break;
+  }
+}
+
+void* worker_main(void* arg) {
+  worker* w = (worker*)arg;
+  while (true) {
+    pthread_mutex_lock(&pending_lock);
+    while (running && pending.empty()) {
+      pthread_cond_wait(&pending_cond, &pending_lock);
+    }
+    if (!running) {
+      pthread_mutex_unlock(&pending_lock);
+      break;
+    }
+    int fd = pending.front();
+    pending.pop_front();
+    w->fd = fd;
+    pthread_mutex_unlock(&pending_lock);
+
+    serve(w, fd);
+    pthread_mutex_lock(&pending_lock);
+    w->fd = -1;
+    pthread_mutex_unlock(&pending_lock);
+    close(fd);
+  }
+  if (w->map) munmap(w->map, w->map_len);
+  return NULL;
+}
+
+
+/* ****************************** */
+int main(int argc, char** argv) {
+
+  const char* socket_path = HULLD_SOCKET;
+  int nworkers = sysconf(_SC_NPROCESSORS_ONLN);
+
+  int c;
+  while ((c = getopt(argc, argv, "s:w:")) != -1) {
+    switch (c) {
+    case 's': socket_path = optarg; break;
+    case 'w': nworkers = atoi(optarg); break;
+    default:
+      printf("usage: %s [-s socket] [-w nworkers]\n", argv[0]);
+      exit(1);
+    }
+  }
+  assert(nworkers > 0);
+
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = on_signal;
+  sigaction(SIGINT, &sa, NULL);
+  sigaction(SIGTERM, &sa, NULL);
+  signal(SIGPIPE, SIG_IGN);
+
+  int lfd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (lfd < 0) {
+    perror("socket");
+    exit(1);
+  }
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1);
+  unlink(socket_path);
+  if (bind(lfd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(lfd, 64) < 0) {
+    perror(socket_path);
+    exit(1);
+  }
+  printf("hulld: listening on %s with %d workers\n", socket_path, nworkers);
+  fflush(stdout);
+
+  //the workers block the signals, so that they interrupt the main thread
+  sigset_t block, old;
+  sigemptyset(&block);
+  sigaddset(&block, SIGINT);
+  sigaddset(&block, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &block, &old);
+  vector<worker> workers(nworkers);
+  for (int i = 0; i < nworkers; i++) {
+    workers[i].fd = -1;
+    workers[i].map = NULL;
+    workers[i].map_len = 0;
+    pthread_create(&workers[i].thread, NULL, worker_main, &workers[i]);
+  }
+  pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+  //accept connections until we are signaled; poll so that the signal
+  //is noticed even if no client connects
+  struct pollfd pfd;
+  pfd.fd = lfd;
+  pfd.events = POLLIN;
+  while (running) {
+    if (poll(&pfd, 1, 200) <= 0) continue;
+    int fd = accept(lfd, NULL, NULL);
+    if (fd < 0) continue;
+    pthread_mutex_lock(&pending_lock);
+    pending.push_back(fd);
+    pthread_cond_signal(&pending_cond);
+    pthread_mutex_unlock(&pending_lock);
+  }
+
+  //wake up the idle workers, and the ones waiting for a request
+  pthread_mutex_lock(&pending_lock);
+  pthread_cond_broadcast(&pending_cond);
+  for (int i = 0; i < nworkers; i++) {
+    if (workers[i].fd >= 0) shutdown(workers[i].fd, SHUT_RDWR);
+  }
+  while (!pending.empty()) {
+    close(pending.front());
+    pending.pop_front();
+  }
+  pthread_mutex_unlock(&pending_lock);
+  for (int i = 0; i < nworkers; i++) {
+    pthread_join(workers[i].thread, NULL);
+  }
+  close(lfd);
+  unlink(socket_path);
+
+  printf("hulld: request latency\n");
+  hist_print(stdout, latency_hist);
+  return 0;
+}
@@ -0,0 +1,23 @@
+#include "hullgeneric.h"
+
+#include <vector>
+
+using namespace std;
+
+
+/* ****************************** */
+int hull_indices_strided(const void* base, int n, size_t stride, size_t xoff, size_t yoff,
+                         vector<int>& idx) {
+  strided_points pts;
+  pts.base = (const char*)base;
+  pts.stride = stride;
+  pts.xoff = xoff;
+  pts.yoff = yoff;
+  return hull_indices_of(pts, n, idx);
+}
+
+
+/* ****************************** */
+int graham_scan_indices(const vector<point2d>& pts, vector<int>& idx) {
+  return hull_indices_of(pts, pts.size(), idx);
+}
@@ -0,0 +1,265 @@
+#ifndef __hullgeneric_h
+#define __hullgeneric_h
+
+#include "geom.h"
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+
+/*
+  hull over points that live inside the caller's own records, without
+  copying them into a vector<point2d>. the hull is returned as the
+  indices of the records on it, in the same order as graham_scan().
+
+  the points are read through a "point source": any type with
+  point2d operator[](int i) const. besides the filter survivors' indices
+  (usually few), no memory proportional to n is used.
+
+  three ways to describe the points:
+    - hull_indices(recs, n, get): get(recs[i]) returns a point2d
+    - hull_indices(recs, n, &Rec::x, &Rec::y): int members of a struct
+    - hull_indices_strided(base, n, stride, xoff, yoff): int x and y at
+      byte offsets xoff and yoff of records stride bytes apart
+*/
+
+
+/* ****************************** */
+/* point sources */
+
+/* reads points through an accessor function or functor */
+template <class Rec, class Get>
+struct accessor_points {
+  const Rec* recs;
+  Get get;
+  point2d operator[](int i) const { return get(recs[i]); }
+};
+
+/* reads points from two int members of a struct */
+template <class Rec>
+struct member_points {
+  const Rec* recs;
+  int Rec::*x;
+  int Rec::*y;
+  point2d operator[](int i) const {
+    point2d p;
+    p.x = recs[i].*x;
+    p.y = recs[i].*y;
+    return p;
+  }
+};
+
+/* reads points from ints at fixed byte offsets of equally spaced records */
+struct strided_points {
+  const char* base;
+  size_t stride, xoff, yoff;
+  point2d operator[](int i) const {
+    point2d p;
+    const char* r = base + (size_t)i * stride;
+    memcpy(&p.x, r + xoff, sizeof(int));
+    memcpy(&p.y, r + yoff, sizeof(int));
+    return p;
+  }
+};
+
+
+/* ****************************** */
+/*
+  the pieces of the graham scan, for every caller: graham_scan_inplace(),
+  the arena graham_scan() and small_hull() in geom.cpp run them on the
+  points themselves, hull_indices_of() below on indices into a point
+  source. the scan and the sort work on an array of items, and a
+  projection gives the point of an item
+*/
+
+/*
+  the order of the radial sort around p0: b is before c if it is
+  counterclockwise from c; if they are collinear with p0 (on the same
+  ray, since every point is above p0 or left of it), the closer one is
+  first. copies of p0 are before everything
+*/
+inline int radial_before(point2d p0, point2d b, point2d c) {
+  long long area = signed_area2D(p0, b, c);
+  if (area != 0) return area > 0;
+  return llabs((long long)b.x - p0.x) + llabs((long long)b.y - p0.y)
+    < llabs((long long)c.x - p0.x) + llabs((long long)c.y - p0.y);
+}
+
+/* projections: the item is the point, or an index into a point source */
+struct point_itself {
+  point2d operator()(point2d p) const { return p; }
+};
+
+template <class Pts>
+struct point_at {
+  const Pts* pts;
+  point2d operator()(int i) const { return (*pts)[i]; }
+};
+
+/* radial_before() on items, for sort(). the projection is a base, so
+   with point_itself the comparator is no bigger than p0 (sort() copies
+   it around) */
+template <class Proj>
+struct radial_less : Proj {
+  point2d p0;
+  radial_less(Proj point, point2d p0) : Proj(point), p0(p0) {}
+  template <class T>
+  bool operator()(const T& a, const T& b) const {
+    return radial_before(p0, Proj::operator()(a), Proj::operator()(b));
+  }
+};
+
+/*
+  the filter: calls keep(i, p) for every point p = pts[i] strictly
+  outside the quadrilateral of the x and y extremes, in order, and then
+  for every distinct extreme. every point is read before keep() is
+  called on it, so keep() may overwrite pts[0..i] (this is how the
+  in-place scans compact their input). returns the number of calls
+*/
+template <class Pts, class Keep>
+int hull_filter_extremes(const Pts& pts, int n, Keep& keep) {
+  int iquad[4] = {0, 0, 0, 0};
+  point2d quad[4];
+  for (int j = 0; j < 4; j++) quad[j] = pts[0];
+  for (int i = 1; i < n; i++) {
+    point2d p = pts[i];
+    if (p.x > quad[0].x) { iquad[0] = i; quad[0] = p; }
+    if (p.y > quad[1].y) { iquad[1] = i; quad[1] = p; }
+    if (p.x < quad[2].x) { iquad[2] = i; quad[2] = p; }
+    if (p.y < quad[3].y) { iquad[3] = i; quad[3] = p; }
+  }
+  //quad is counterclockwise, possibly with duplicates
+
+  int k = 0;
+  for (int i = 0; i < n; i++) {
+    point2d p = pts[i];
+    for (int j = 0; j < 4; j++) {
+      if (!left_on(quad[j], quad[(j + 1) % 4], p)) {
+        keep(i, p);
+        k++;
+        break;
+      }
+    }
+  }
+  //the extremes are not strictly outside, so in place there is room
+  //for them after the outside points: every distinct one freed a slot
+  for (int j = 0; j < 4; j++) {
+    int seen = 0;
+    for (int l = 0; l < j; l++) {
+      if (quad[l].x == quad[j].x && quad[l].y == quad[j].y) seen = 1;
+    }
+    if (!seen) {
+      keep(iquad[j], quad[j]);
+      k++;
+    }
+  }
+  return k;
+}
+
+/* moves the bottom item of items[0..k) (lowest, then rightmost) to the
+   front, and returns its point p0 */
+template <class T, class Proj>
+point2d move_bottom_first(T* items, int k, Proj point) {
+  int b = 0;
+  point2d p0 = point(items[0]);
+  for (int i = 1; i < k; i++) {
+    point2d p = point(items[i]);
+    if (p.y < p0.y || (p.y == p0.y && p.x > p0.x)) {
+      b = i;
+      p0 = p;
+    }
+  }
+  swap(items[0], items[b]);
+  return p0;
+}
+
+/*
+  the scan, on items[0..k) radially sorted around the point p0 of
+  items[0]: items[0..top) is the hull stack. top <= i, so pushing
+  items[i] never overwrites an item that has not been scanned yet.
+  returns h, the hull is items[0..h)
+*/
+template <class T, class Proj>
+int hull_scan_sorted(T* items, int k, Proj point) {
+  point2d p0 = point(items[0]);
+  int top = 1;
+  for (int i = 1; i < k; i++) {
+    point2d p = point(items[i]);
+    while (top >= 2 && !left_strictly(point(items[top-2]), point(items[top-1]), p)) {
+      top--;
+    }
+    //skip copies of p0
+    if (top == 1 && p.x == p0.x && p.y == p0.y) continue;
+    items[top++] = items[i];
+  }
+  //finally, check the last point with the first point on the hull
+  while (top > 2 && !left_strictly(point(items[top-2]), point(items[top-1]), p0)) {
+    top--;
+  }
+  return top;
+}
+
+
+/* ****************************** */
+/* keeps the filter survivors of a point source as indices */
+struct keep_index {
+  vector<int>* idx;
+  void operator()(int i, point2d p) { idx->push_back(i); }
+};
+
+/*
+  the graham scan pipeline over a point source: filter by the
+  quadrilateral of the extremes, sort the survivors' indices radially,
+  scan with idx as the stack. stores the indices of the hull points in
+  idx and returns their number
+*/
+template <class Pts>
+int hull_indices_of(const Pts& pts, int n, vector<int>& idx) {
+  idx.clear();
+  if (n == 0) return 0;
+
+  keep_index keep = {&idx};
+  int k = hull_filter_extremes(pts, n, keep);
+
+  //bottom point first, the rest sorted around it
+  point_at<Pts> at = {&pts};
+  radial_less<point_at<Pts> > less(at, move_bottom_first(idx.data(), k, at));
+  sort(idx.begin() + 1, idx.end(), less);
+
+  int h = hull_scan_sorted(idx.data(), k, at);
+  idx.resize(h);
+  return h;
+}
+
+
+/* ****************************** */
+/* hull of get(recs[0]), ..., get(recs[n-1]); get returns a point2d */
+template <class Rec, class Get>
+int hull_indices(const Rec* recs, int n, Get get, vector<int>& idx) {
+  accessor_points<Rec, Get> pts = {recs, get};
+  return hull_indices_of(pts, n, idx);
+}
+
+/* hull of the points (recs[i].*x, recs[i].*y) */
+template <class Rec>
+int hull_indices(const Rec* recs, int n, int Rec::*x, int Rec::*y, vector<int>& idx) {
+  member_points<Rec> pts = {recs, x, y};
+  return hull_indices_of(pts, n, idx);
+}
+
+/* hull of points stored as ints at byte offsets xoff, yoff of n records
+   that are stride bytes apart, starting at base */
+int hull_indices_strided(const void* base, int n, size_t stride, size_t xoff, size_t yoff,
+                         vector<int>& idx);
+
+/* index-returning graham scan over a plain vector of points */
+int graham_scan_indices(const vector<point2d>& pts, vector<int>& idx);
+
+
+#endif
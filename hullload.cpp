@@ -0,0 +1,188 @@
+/* hullload.cpp
+
+   Load generator for hulld. Starts C client threads; each one creates
+   its own shared memory segment, connects to the daemon and sends R
+   hull requests of n random points, checking every reply against the
+   hull computed locally. Prints the client-side latency histogram and
+   the throughput, then the daemon's own histogram.
+
+   usage: hullload [-s socket] [-c clients] [-r requests] [-n npoints]
+*/
+
+#include "geom.h"
+#include "hullgeneric.h"
+#include "hullproto.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <vector>
+using namespace std;
+
+
+/* global variables */
+
+const char* socket_path = HULLD_SOCKET;
+int NREQUESTS = 1000;
+int NPOINTS = 1000;
+
+long client_hist[HULLD_NBUCKETS];
+long nerrors = 0;
+pthread_mutex_t hist_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
+/* ****************************** */
+static double now_usec() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/* connects to the daemon; returns the socket, or -1 */
+int connect_daemon() {
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1);
+  if (fd < 0 || connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+    perror(socket_path);
+    if (fd >= 0) close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+
+/* ****************************** */
+void* client_main(void* arg) {
+  long id = (long)arg;
+  unsigned int seed = id + 1;
+
+  hulld_request req;
+  memset(&req, 0, sizeof(req));
+  req.magic = HULLD_MAGIC;
+  req.op = HULLD_OP_HULL;
+  req.n = NPOINTS;
+  snprintf(req.shm_name, sizeof(req.shm_name), "/hullload-%d-%ld", (int)getpid(), id);
+
+  //one segment per client, reused for all its requests
+  size_t len = hulld_segment_size(NPOINTS);
+  int sfd = shm_open(req.shm_name, O_CREAT | O_RDWR | O_EXCL, 0600);
+  if (sfd < 0 || ftruncate(sfd, len) < 0) {
+    perror(req.shm_name);
+    exit(1);
+  }
+  void* seg = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, sfd, 0);
+  close(sfd);
+  if (seg == MAP_FAILED) {
+    perror("mmap segment");
+    exit(1);
+  }
+  point2d* pts = (point2d*)seg;
+  int* idx = hulld_segment_indices(seg, NPOINTS);
+
+  int fd = connect_daemon();
+  if (fd < 0) {
+    shm_unlink(req.shm_name);
+    exit(1);
+  }
+
+  long hist[HULLD_NBUCKETS];
+  memset(hist, 0, sizeof(hist));
+  long errors = 0;
+  vector<int> expected;
+  for (int r = 0; r < NREQUESTS; r++) {
+    for (int i = 0; i < NPOINTS; i++) {
+      pts[i].x = rand_r(&seed) % 500;
+      pts[i].y = rand_r(&seed) % 500;
+    }
+    hulld_reply reply;
+    double t0 = now_usec();
+    if (!write_full(fd, &req, sizeof(req)) || !read_full(fd, &reply, sizeof(reply))) {
+      fprintf(stderr, "hullload: connection closed\n");
+      shm_unlink(req.shm_name);
+      exit(1);
+    }
+    hist_add(hist, now_usec() - t0);
+
+    //check the answer
+    hull_indices(pts, NPOINTS, &point2d::x, &point2d::y, expected);
+    if (reply.status != HULLD_OK || reply.h != (long)expected.size()
+        || memcmp(idx, expected.data(), reply.h * sizeof(int)) != 0) {
+      errors++;
+    }
+  }
+
+  close(fd);
+  munmap(seg, len);
+  shm_unlink(req.shm_name);
+
+  pthread_mutex_lock(&hist_lock);
+  for (int b = 0; b < HULLD_NBUCKETS; b++) client_hist[b] += hist[b];
+  nerrors += errors;
+  pthread_mutex_unlock(&hist_lock);
+  return NULL;
+}
+
+
+/* ****************************** */
+int main(int argc, char** argv) {
+
+  int nclients = 4;
+  int c;
+  while ((c = getopt(argc, argv, "s:c:r:n:")) != -1) {
+    switch (c) {
+    case 's': socket_path = optarg; break;
+    case 'c': nclients = atoi(optarg); break;
+    case 'r': NREQUESTS = atoi(optarg); break;
+    case 'n': NPOINTS = atoi(optarg); break;
+    default:
+      printf("usage: %s [-s socket] [-c clients] [-r requests] [-n npoints]\n", argv[0]);
+      exit(1);
+    }
+  }
+  assert(nclients > 0 && NREQUESTS > 0 && NPOINTS > 0);
+  printf("hullload: %d clients x %d requests of %d points\n", nclients, NREQUESTS, NPOINTS);
+
+  double t0 = now_usec();
+  vector<pthread_t> threads(nclients);
+  for (long i = 0; i < nclients; i++) {
+    pthread_create(&threads[i], NULL, client_main, (void*)i);
+  }
+  for (int i = 0; i < nclients; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  double elapsed = now_usec() - t0;
+
+  long total = (long)nclients * NREQUESTS;
+  printf("client latency (round trip, includes the daemon's time)\n");
+  hist_print(stdout, client_hist);
+  printf("  %.0f requests/s, %ld wrong answers\n", total / (elapsed / 1e6), nerrors);
+
+  //ask the daemon for its side of the story
+  int fd = connect_daemon();
+  if (fd >= 0) {
+    hulld_request req;
+    hulld_reply reply;
+    memset(&req, 0, sizeof(req));
+    req.magic = HULLD_MAGIC;
+    req.op = HULLD_OP_STATS;
+    if (write_full(fd, &req, sizeof(req)) && read_full(fd, &reply, sizeof(reply))) {
+      printf("daemon latency (all requests since it started)\n");
+      hist_print(stdout, reply.hist);
+    }
+    close(fd);
+  }
+  return nerrors ? 1 : 0;
+}
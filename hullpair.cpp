@@ -0,0 +1,506 @@
+#include "hullpair.h"
+#include <assert.h>
+#include <pthread.h>
+
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+
+/* ****************************** */
+/* the cross product of (ux, uy) and (vx, vy) */
+static inline long long cross(long long ux, long long uy, long long vx, long long vy) {
+  return ux * vy - uy * vx;
+}
+
+
+/* ****************************** */
+/*
+  1 if an edge of p has all of q strictly right of its line, i.e. outside
+  p. the vertex of q farthest left of edge i is extreme in the direction
+  of its normal, which turns CCW with i, so it only moves forward: one
+  walk around each hull
+*/
+static int edge_separates(const vector<point2d>& p, const vector<point2d>& q) {
+  int hp = p.size(), hq = q.size();
+  if (hp < 2) return 0;
+  int j = 0;
+  for (int i = 0; i < hp; i++) {
+    point2d a = p[i], b = p[(i + 1) % hp];
+    long long ex = (long long)b.x - a.x, ey = (long long)b.y - a.y;
+    if (i == 0) {
+      for (int k = 1; k < hq; k++) {
+        if (cross(ex, ey, (long long)q[k].x - q[j].x, (long long)q[k].y - q[j].y) > 0) j = k;
+      }
+    } else {
+      //through ties too: for a segment p the direction turns by pi,
+      //and j may start on a minimum, with an edge of q parallel to it
+      for (int steps = 1; steps < hq; steps++) {
+        int nj = (j + 1) % hq;
+        if (cross(ex, ey, (long long)q[nj].x - q[j].x, (long long)q[nj].y - q[j].y) < 0) break;
+        j = nj;
+      }
+    }
+    if (cross(ex, ey, (long long)q[j].x - a.x, (long long)q[j].y - a.y) < 0) return 1;
+  }
+  return 0;
+}
+
+/* for a segment p (and a point or segment q): 1 if q is beyond one of
+   its ends, along it. two segments on one line are only separated so */
+static int direction_separates(const vector<point2d>& p, const vector<point2d>& q) {
+  if (p.size() != 2) return 0;
+  long long dx = (long long)p[1].x - p[0].x, dy = (long long)p[1].y - p[0].y;
+  long long p0 = dx * p[0].x + dy * p[0].y, p1 = dx * p[1].x + dy * p[1].y;
+  long long qmin = dx * q[0].x + dy * q[0].y, qmax = qmin;
+  for (size_t k = 1; k < q.size(); k++) {
+    long long d = dx * q[k].x + dy * q[k].y;
+    qmin = min(qmin, d);
+    qmax = max(qmax, d);
+  }
+  return qmax < p0 || qmin > p1;
+}
+
+int hull_overlap(const vector<point2d>& a, const vector<point2d>& b) {
+  if (a.empty() || b.empty()) return 0;
+  if (edge_separates(a, b) || edge_separates(b, a)) return 0;
+  if (a.size() <= 2 && b.size() <= 2) {
+    if (direction_separates(a, b) || direction_separates(b, a)) return 0;
+    if (a.size() == 1 && b.size() == 1) return a[0].x == b[0].x && a[0].y == b[0].y;
+  }
+  return 1;
+}
+
+
+/* ****************************** */
+/* 0 for the directions of angle in (0, pi], 1 for (pi, 2 pi]: the
+   order of the edges of a hull that starts at its bottom point */
+static inline int half(long long dx, long long dy) {
+  return (dy > 0 || (dy == 0 && dx < 0)) ? 0 : 1;
+}
+
+int hull_minkowski_sum(const vector<point2d>& a, const vector<point2d>& b,
+                       vector<point2d>& sum) {
+  sum.clear();
+  if (a.empty() || b.empty()) return 0;
+  int ha = a.size(), hb = b.size();
+  //a point has no edges
+  int ea = (ha > 1) ? ha : 0, eb = (hb > 1) ? hb : 0;
+  sum.reserve(ea + eb + 1);
+
+  //both start at their bottom point, so the sum starts at theirs
+  point2d cur = {a[0].x + b[0].x, a[0].y + b[0].y};
+  sum.push_back(cur);
+  int i = 0, j = 0;
+  while (i < ea || j < eb) {
+    long long ax = 0, ay = 0, bx = 0, by = 0;
+    if (i < ea) {
+      ax = (long long)a[(i + 1) % ha].x - a[i].x;
+      ay = (long long)a[(i + 1) % ha].y - a[i].y;
+    }
+    if (j < eb) {
+      bx = (long long)b[(j + 1) % hb].x - b[j].x;
+      by = (long long)b[(j + 1) % hb].y - b[j].y;
+    }
+    //the edge of smaller angle goes first; parallel edges together
+    int take_a = i < ea, take_b = j < eb;
+    if (take_a && take_b) {
+      int ha_ = half(ax, ay), hb_ = half(bx, by);
+      long long c = cross(ax, ay, bx, by);
+      if (ha_ != hb_) {
+        take_a = ha_ < hb_;
+        take_b = !take_a;
+      } else if (c != 0) {
+        take_a = c > 0;
+        take_b = !take_a;
+      }
+    }
+    if (take_a) {
+      cur.x += ax;
+      cur.y += ay;
+      i++;
+    }
+    if (take_b) {
+      cur.x += bx;
+      cur.y += by;
+      j++;
+    }
+    if (i < ea || j < eb) sum.push_back(cur);
+  }
+  return sum.size();
+}
+
+
+/* ****************************** */
+/* a lower or upper chain of a hull: its vertices by increasing x, and
+   the edge of the last evaluation (the sweep only moves right) */
+typedef struct _chain {
+  vector<point2d> v;
+  int k;
+} chain;
+
+/* the lower and upper chains of a hull, from its leftmost to its
+   rightmost vertices; a vertical edge at either end is in neither */
+static void split_chains(const vector<point2d>& h, chain* lower, chain* upper) {
+  int n = h.size();
+  int lmin = 0, umin = 0, lmax = 0, umax = 0;
+  for (int i = 1; i < n; i++) {
+    if (h[i].x < h[lmin].x || (h[i].x == h[lmin].x && h[i].y < h[lmin].y)) lmin = i;
+    if (h[i].x < h[umin].x || (h[i].x == h[umin].x && h[i].y > h[umin].y)) umin = i;
+    if (h[i].x > h[lmax].x || (h[i].x == h[lmax].x && h[i].y < h[lmax].y)) lmax = i;
+    if (h[i].x > h[umax].x || (h[i].x == h[umax].x && h[i].y > h[umax].y)) umax = i;
+  }
+  //CCW goes along the bottom from left to right, and CW along the top
+  lower->v.clear();
+  for (int i = lmin; ; i = (i + 1) % n) {
+    lower->v.push_back(h[i]);
+    if (i == lmax) break;
+  }
+  upper->v.clear();
+  for (int i = umin; ; i = (i + n - 1) % n) {
+    upper->v.push_back(h[i]);
+    if (i == umax) break;
+  }
+  lower->k = upper->k = 0;
+}
+
+/* moves c to the edge that contains x, and returns y there. x is the x
+   of a vertex, or right: y is exact when it is an integer, so that a
+   vertex on an edge of the other hull is found on it */
+static double chain_y(chain* c, int x) {
+  int n = c->v.size();
+  if (n == 1) return c->v[0].y;
+  while (c->k + 2 < n && c->v[c->k + 1].x < x) c->k++;
+  const point2d& p = c->v[c->k];
+  const point2d& q = c->v[c->k + 1];
+  long long num = ((long long)q.y - p.y) * ((long long)x - p.x), dx = (long long)q.x - p.x;
+  return p.y + (double)(num / dx) + (double)(num % dx) / dx;
+}
+
+/* the slope of the edge of the last chain_y(), as dy / dx with dx > 0 */
+typedef struct _slope {
+  long long dy, dx;
+} slope;
+
+static slope chain_slope(const chain* c) {
+  slope s = {0, 1};
+  if (c->v.size() > 1) {
+    const point2d& p = c->v[c->k];
+    const point2d& q = c->v[c->k + 1];
+    s.dy = (long long)q.y - p.y;
+    s.dx = (long long)q.x - p.x;
+  }
+  return s;
+}
+
+static inline int same_slope(slope s, slope t) {
+  return s.dy * t.dx == t.dy * s.dx;
+}
+
+/* the next vertex x of c after x, or limit if there is none before it */
+static inline int next_x(const chain* c, int x, int limit) {
+  //k is at most one edge behind x, so this is a short scan
+  for (int i = c->k; i < (int)c->v.size(); i++) {
+    if (c->v[i].x > x) return min(c->v[i].x, limit);
+  }
+  return limit;
+}
+
+/* a point of the sweep: the max of the lower chains and the min of the
+   upper chains at x */
+typedef struct _sweep_point {
+  double x, lo, hi;
+} sweep_point;
+
+/* x, then y */
+static inline int fxy_less(const fpoint2d& a, const fpoint2d& b) {
+  return a.x < b.x || (a.x == b.x && a.y < b.y);
+}
+
+static inline int same_fpoint(const fpoint2d& a, const fpoint2d& b) {
+  return a.x == b.x && a.y == b.y;
+}
+
+/*
+  p is the lower boundary of the intersection left to right (its first
+  nlower points), then the upper boundary right to left. replaces it
+  with the hull of its points, starting at the bottom point (rightmost
+  if tied), with no collinear vertices. the boundaries are convex up to
+  the rounding of the crossings, and may have collapsed onto each other
+  (a segment or a point), so the hull is recomputed rather than cleaned
+  up in place: Andrew's monotone chain over the two boundaries merged
+  by x, which takes linear time
+*/
+static void clean_convex(vector<fpoint2d>& p, int nlower) {
+  reverse(p.begin() + nlower, p.end());
+  vector<fpoint2d> s(p.size());
+  merge(p.begin(), p.begin() + nlower, p.begin() + nlower, p.end(), s.begin(), fxy_less);
+  //rounding can leave two points at the same x out of order in y
+  if (!is_sorted(s.begin(), s.end(), fxy_less)) sort(s.begin(), s.end(), fxy_less);
+  s.erase(unique(s.begin(), s.end(), same_fpoint), s.end());
+  int n = s.size();
+  if (n <= 1) {
+    p.swap(s);
+    return;
+  }
+
+  //the lower hull left to right, then the upper hull back; with all
+  //points collinear both are the two extremes
+  p.resize(2 * n);
+  int k = 0;
+  for (int i = 0; i < n; i++) {
+    while (k >= 2 && !left_strictly(p[k-2], p[k-1], s[i])) k--;
+    p[k++] = s[i];
+  }
+  for (int i = n - 2, lower = k + 1; i >= 0; i--) {
+    while (k >= lower && !left_strictly(p[k-2], p[k-1], s[i])) k--;
+    p[k++] = s[i];
+  }
+  p.resize(k - 1);
+
+  int b = 0;
+  for (int i = 1; i < k - 1; i++) {
+    if (p[i].y < p[b].y || (p[i].y == p[b].y && p[i].x > p[b].x)) b = i;
+  }
+  rotate(p.begin(), p.begin() + b, p.end());
+}
+
+int hull_intersection(const vector<point2d>& a, const vector<point2d>& b,
+                      vector<fpoint2d>& out) {
+  out.clear();
+  if (a.empty() || b.empty()) return 0;
+  chain la, ua, lb, ub;
+  split_chains(a, &la, &ua);
+  split_chains(b, &lb, &ub);
+  int left = max(la.v.front().x, lb.v.front().x);
+  int right = min(la.v.back().x, lb.v.back().x);
+  if (left > right) return 0;
+
+  //the sweep, from vertex x to vertex x of any of the four chains. in
+  //between all four are linear, so lower (and upper) change sides at
+  //most once; that is a vertex too. slopes[i] is the slope of lo and hi
+  //from pts[i] to pts[i+1]
+  vector<sweep_point> pts;
+  vector<slope> lslopes, uslopes;
+  //a point per vertex x, and at most two crossings per interval
+  size_t most = 3 * (a.size() + b.size()) + 1;
+  pts.reserve(most);
+  lslopes.reserve(most);
+  uslopes.reserve(most);
+  int x = left;
+  double yla = chain_y(&la, x), ylb = chain_y(&lb, x);
+  double yua = chain_y(&ua, x), yub = chain_y(&ub, x);
+  sweep_point sp = {(double)x, max(yla, ylb), min(yua, yub)};
+  pts.push_back(sp);
+  while (x < right) {
+    int nx = right;
+    nx = next_x(&la, x, nx);
+    nx = next_x(&lb, x, nx);
+    nx = next_x(&ua, x, nx);
+    nx = next_x(&ub, x, nx);
+    double nla = chain_y(&la, nx), nlb = chain_y(&lb, nx);
+    double nua = chain_y(&ua, nx), nub = chain_y(&ub, nx);
+    slope sla = chain_slope(&la), slb = chain_slope(&lb);
+    slope sua = chain_slope(&ua), sub = chain_slope(&ub);
+
+    //where the lower chains, and the upper ones, cross, as fractions of
+    //the way from x to nx. at a crossing both chains have the value of
+    //the first: taking the max of two roundings of it would make two
+    //crossing segments miss each other
+    const int LOWER = 1, UPPER = 2;
+    double dl0 = yla - ylb, dl1 = nla - nlb;
+    double du0 = yua - yub, du1 = nua - nub;
+    double cuts[3];
+    int kinds[3], ncuts = 0;
+    if ((dl0 < 0 && dl1 > 0) || (dl0 > 0 && dl1 < 0)) {
+      cuts[ncuts] = dl0 / (dl0 - dl1);
+      kinds[ncuts++] = LOWER;
+    }
+    if ((du0 < 0 && du1 > 0) || (du0 > 0 && du1 < 0)) {
+      cuts[ncuts] = du0 / (du0 - du1);
+      kinds[ncuts++] = UPPER;
+    }
+    if (ncuts == 2 && cuts[0] == cuts[1]) {
+      kinds[0] |= kinds[1];
+      ncuts = 1;
+    } else if (ncuts == 2 && cuts[1] < cuts[0]) {
+      swap(cuts[0], cuts[1]);
+      swap(kinds[0], kinds[1]);
+    }
+    cuts[ncuts] = 1;
+    kinds[ncuts++] = 0;
+
+    double prev = 0;
+    for (int c = 0; c < ncuts; c++) {
+      double t = cuts[c];
+      //which chains are lo and hi on (prev, t), from the middle
+      double m = (prev + t) / 2;
+      lslopes.push_back(dl0 + (dl1 - dl0) * m >= 0 ? sla : slb);
+      uslopes.push_back(du0 + (du1 - du0) * m <= 0 ? sua : sub);
+      if (t == 1) {
+        sp.x = nx;
+        sp.lo = max(nla, nlb);
+        sp.hi = min(nua, nub);
+      } else {
+        double la_t = yla + (nla - yla) * t, ua_t = yua + (nua - yua) * t;
+        double lb_t = ylb + (nlb - ylb) * t, ub_t = yub + (nub - yub) * t;
+        //the chains of b are the same segment if b is one (or the chains
+        //of a, but those are rounded alike); then both take the value of
+        //the crossing, or lo would be above hi by a rounding
+        int b_flat = ylb == yub && nlb == nub;
+        if (kinds[c] & LOWER) {
+          lb_t = la_t;
+          if (b_flat) ub_t = la_t;
+        }
+        if (kinds[c] & UPPER) {
+          ub_t = ua_t;
+          if (b_flat) lb_t = ua_t;
+        }
+        sp.x = x + (nx - x) * t;
+        sp.lo = max(la_t, lb_t);
+        sp.hi = min(ua_t, ub_t);
+      }
+      pts.push_back(sp);
+      prev = t;
+    }
+    x = nx;
+    yla = nla;
+    ylb = nlb;
+    yua = nua;
+    yub = nub;
+  }
+
+  //hi - lo is concave, so it is >= 0 on one interval [xl, xr]
+  int n = pts.size();
+  int i0 = 0, i1 = n - 1;
+  while (i0 < n && pts[i0].hi < pts[i0].lo) i0++;
+  if (i0 == n) return 0;
+  while (pts[i1].hi < pts[i1].lo) i1--;
+
+  //the ends, where hi meets lo if it is not at left or right
+  sweep_point end[2];
+  for (int e = 0; e < 2; e++) {
+    int i = e ? i1 : i0, o = e ? i1 + 1 : i0 - 1;
+    end[e] = pts[i];
+    if (o >= 0 && o < n) {
+      double g0 = pts[o].hi - pts[o].lo, g1 = pts[i].hi - pts[i].lo;
+      double t = g0 / (g0 - g1);
+      end[e].x = pts[o].x + (pts[i].x - pts[o].x) * t;
+      end[e].lo = end[e].hi = pts[o].lo + (pts[i].lo - pts[o].lo) * t;
+    }
+  }
+
+  //the lower boundary left to right, then the upper one back, keeping
+  //the points where the slope changes
+  fpoint2d p;
+  p.x = end[0].x; p.y = end[0].lo;
+  out.push_back(p);
+  for (int i = i0; i <= i1; i++) {
+    if (pts[i].x <= end[0].x || pts[i].x >= end[1].x) continue;
+    if (same_slope(lslopes[i - 1], lslopes[i])) continue;
+    p.x = pts[i].x; p.y = pts[i].lo;
+    out.push_back(p);
+  }
+  p.x = end[1].x; p.y = end[1].lo;
+  out.push_back(p);
+  int nlower = out.size();
+  p.y = end[1].hi;
+  out.push_back(p);
+  for (int i = i1; i >= i0; i--) {
+    if (pts[i].x <= end[0].x || pts[i].x >= end[1].x) continue;
+    if (same_slope(uslopes[i - 1], uslopes[i])) continue;
+    p.x = pts[i].x; p.y = pts[i].hi;
+    out.push_back(p);
+  }
+  p.x = end[0].x; p.y = end[0].hi;
+  out.push_back(p);
+
+  clean_convex(out, nlower);
+  return out.size();
+}
+
+
+/* ****************************** */
+#define PAIR_OVERLAP   0
+#define PAIR_MINKOWSKI 1
+#define PAIR_INTERSECT 2
+
+typedef struct _pair_job {
+  int op;
+  const vector<vector<point2d> >* hulls;
+  const vector<pair<int,int> >* pairs;
+  long begin, end;
+  void* out;   //the vector of results of op
+} pair_job;
+
+static void* pair_slice(void* arg) {
+  pair_job* job = (pair_job*)arg;
+  const vector<vector<point2d> >& h = *job->hulls;
+  for (long i = job->begin; i < job->end; i++) {
+    const vector<point2d>& a = h[(*job->pairs)[i].first];
+    const vector<point2d>& b = h[(*job->pairs)[i].second];
+    switch (job->op) {
+    case PAIR_OVERLAP:
+      (*(vector<char>*)job->out)[i] = hull_overlap(a, b);
+      break;
+    case PAIR_MINKOWSKI:
+      hull_minkowski_sum(a, b, (*(vector<vector<point2d> >*)job->out)[i]);
+      break;
+    case PAIR_INTERSECT:
+      hull_intersection(a, b, (*(vector<vector<fpoint2d> >*)job->out)[i]);
+      break;
+    }
+  }
+  return NULL;
+}
+
+/* runs op on all the pairs, into out, which has an entry per pair */
+static void run_pairs(int op, const vector<vector<point2d> >& hulls,
+                      const vector<pair<int,int> >& pairs, void* out, int nthreads) {
+  long n = pairs.size();
+  if (n == 0) return;
+  if (nthreads < 1) nthreads = 1;
+  if (nthreads > n) nthreads = n;
+
+  vector<pair_job> jobs(nthreads);
+  vector<pthread_t> threads(nthreads);
+  vector<char> started(nthreads, 0);
+  for (int t = 0; t < nthreads; t++) {
+    jobs[t].op = op;
+    jobs[t].hulls = &hulls;
+    jobs[t].pairs = &pairs;
+    jobs[t].begin = n * t / nthreads;
+    jobs[t].end = n * (t + 1) / nthreads;
+    jobs[t].out = out;
+  }
+  //the first slice is done by this thread
+  for (int t = 1; t < nthreads; t++) {
+    started[t] = pthread_create(&threads[t], NULL, pair_slice, &jobs[t]) == 0;
+    if (!started[t]) pair_slice(&jobs[t]);
+  }
+  pair_slice(&jobs[0]);
+  for (int t = 1; t < nthreads; t++) {
+    if (started[t]) pthread_join(threads[t], NULL);
+  }
+}
+
+void hull_overlap_batch(const vector<vector<point2d> >& hulls, const vector<pair<int,int> >& pairs,
+                        vector<char>& overlap, int nthreads) {
+  overlap.assign(pairs.size(), 0);
+  run_pairs(PAIR_OVERLAP, hulls, pairs, &overlap, nthreads);
+}
+
+void hull_minkowski_sum_batch(const vector<vector<point2d> >& hulls,
+                              const vector<pair<int,int> >& pairs,
+                              vector<vector<point2d> >& sums, int nthreads) {
+  sums.resize(pairs.size());
+  run_pairs(PAIR_MINKOWSKI, hulls, pairs, &sums, nthreads);
+}
+
+void hull_intersection_batch(const vector<vector<point2d> >& hulls,
+                             const vector<pair<int,int> >& pairs,
+                             vector<vector<fpoint2d> >& out, int nthreads) {
+  out.resize(pairs.size());
+  run_pairs(PAIR_INTERSECT, hulls, pairs, &out, nthreads);
+}
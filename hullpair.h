@@ -0,0 +1,71 @@
+#ifndef __hullpair_h
+#define __hullpair_h
+
+#include "geom.h"
+#include "geomf.h"
+
+#include <vector>
+#include <utility>
+
+using namespace std;
+
+
+/*
+  operations on two convex hulls as produced by graham_scan(): CCW
+  order, hull[0] the bottom point (rightmost if tied), no three
+  collinear vertices. a hull of 1 or 2 points is a point or a segment.
+  every operation walks the two hulls together, in O(h1 + h2), instead
+  of computing the hull of the points of both.
+
+  the predicates are exact for coordinates of absolute value below 2^30
+  (like signed_area2D()), and so is the Minkowski sum, whose coordinates
+  are sums of two. the intersection has new vertices where edges cross,
+  so it is in doubles.
+*/
+
+
+/* returns 1 if the hulls have a point in common (touching counts), 0
+   if a line separates them. the separating axis test, with the edges
+   of both as the axes; the vertex of the other hull that is extreme
+   along an edge's normal only moves forward as the edge does */
+int hull_overlap(const vector<point2d>& a, const vector<point2d>& b);
+
+/*
+  stores in sum the Minkowski sum of the hulls, {p + q : p in a, q in b},
+  as a hull in the same order: the edges of both merged by angle, and
+  parallel edges joined. returns its size
+*/
+int hull_minkowski_sum(const vector<point2d>& a, const vector<point2d>& b,
+                       vector<point2d>& sum);
+
+/*
+  stores in out the intersection of the hulls, as a hull in the same
+  order; fewer than 3 points if they only touch (a point or a segment),
+  empty if they do not overlap. returns its size.
+
+  a sweep in x over the lower and the upper chains of both: between two
+  consecutive vertex x's the boundary of the intersection is the max of
+  the lower chains and the min of the upper chains, and it only has a
+  vertex where one of them does, or where two chains cross
+*/
+int hull_intersection(const vector<point2d>& a, const vector<point2d>& b,
+                      vector<fpoint2d>& out);
+
+
+/*
+  the same on many pairs of hulls, hulls[pairs[i].first] with
+  hulls[pairs[i].second], with nthreads threads; the result for pair i
+  is in the i-th entry. the pairs are cut into nthreads contiguous
+  slices, like parallel_hull()
+*/
+void hull_overlap_batch(const vector<vector<point2d> >& hulls, const vector<pair<int,int> >& pairs,
+                        vector<char>& overlap, int nthreads);
+void hull_minkowski_sum_batch(const vector<vector<point2d> >& hulls,
+                              const vector<pair<int,int> >& pairs,
+                              vector<vector<point2d> >& sums, int nthreads);
+void hull_intersection_batch(const vector<vector<point2d> >& hulls,
+                             const vector<pair<int,int> >& pairs,
+                             vector<vector<fpoint2d> >& out, int nthreads);
+
+
+#endif
@@ -0,0 +1,77 @@
+#include "hullproto.h"
+
+#include <stdio.h>
+#include <unistd.h>
+#include <errno.h>
+#include <math.h>
+
+
+/* ****************************** */
+size_t hulld_segment_size(long n) {
+  return n * (sizeof(point2d) + sizeof(int));
+}
+
+int* hulld_segment_indices(void* segment, long n) {
+  return (int*)((char*)segment + n * sizeof(point2d));
+}
+
+
+/* ****************************** */
+int read_full(int fd, void* buf, size_t len) {
+  char* p = (char*)buf;
+  while (len > 0) {
+    ssize_t r = read(fd, p, len);
+    if (r < 0 && errno == EINTR) continue;
+    if (r <= 0) return 0;
+    p += r;
+    len -= r;
+  }
+  return 1;
+}
+
+int write_full(int fd, const void* buf, size_t len) {
+  const char* p = (const char*)buf;
+  while (len > 0) {
+    ssize_t r = write(fd, p, len);
+    if (r < 0 && errno == EINTR) continue;
+    if (r <= 0) return 0;
+    p += r;
+    len -= r;
+  }
+  return 1;
+}
+
+
+/* ****************************** */
+void hist_add(long* hist, double usec) {
+  int b = 0;
+  while (b < HULLD_NBUCKETS - 1 && usec >= (double)(2L << b)) b++;
+  hist[b]++;
+}
+
+double hist_percentile(const long* hist, double p) {
+  long total = 0;
+  for (int b = 0; b < HULLD_NBUCKETS; b++) total += hist[b];
+  long seen = 0;
+  for (int b = 0; b < HULLD_NBUCKETS; b++) {
+    seen += hist[b];
+    if (seen > 0 && seen >= p / 100 * total) return (double)(2L << b);
+  }
+  return 0;
+}
+
+void hist_print(FILE* f, const long* hist) {
+  long total = 0;
+  for (int b = 0; b < HULLD_NBUCKETS; b++) total += hist[b];
+  if (total == 0) {
+    fprintf(f, "  no requests\n");
+    return;
+  }
+  for (int b = 0; b < HULLD_NBUCKETS; b++) {
+    if (hist[b] == 0) continue;
+    fprintf(f, "  [%9ld, %9ld) us: %8ld  %5.1f%%\n", b ? (1L << b) : 0L, 2L << b,
+            hist[b], 100.0 * hist[b] / total);
+  }
+  fprintf(f, "  %ld requests, p50 < %.0f us, p90 < %.0f us, p99 < %.0f us\n", total,
+          hist_percentile(hist, 50), hist_percentile(hist, 90), hist_percentile(hist, 99));
+}
@@ -0,0 +1,77 @@
+/*
+  Protocol between the hull daemon (hulld) and its clients.
+
+  A client puts a batch of n points in a POSIX shared memory segment
+  (shm_open) big enough for n point2d's followed by n ints, and sends a
+  hulld_request naming the segment over the daemon's Unix domain socket.
+  The daemon computes the hull of the points, writes the indices of the
+  hull points (in graham_scan() order) into the ints after the points,
+  and sends back a hulld_reply. A client normally creates one segment
+  and reuses it for all its requests, growing it if a batch does not
+  fit; the daemon keeps it mapped for as long as the connection uses the
+  same segment, and maps it again when it has been resized or recreated.
+  n must fit in an int.
+*/
+
+#ifndef __hullproto_h
+#define __hullproto_h
+
+#include "geom.h"
+
+#include <stddef.h>
+#include <stdio.h>
+
+
+#define HULLD_MAGIC 0x68756c6c  /* "hull" */
+#define HULLD_SOCKET "/tmp/hulld.sock"
+
+/* request ops */
+#define HULLD_OP_HULL  1   /* compute the hull of the points in the segment */
+#define HULLD_OP_STATS 2   /* return the daemon's latency histogram */
+
+/* reply status */
+#define HULLD_OK         0
+#define HULLD_EBADREQ    1  /* bad magic or op */
+#define HULLD_ESHM       2  /* the segment cannot be mapped, or is too small */
+
+/* latency histogram: bucket i counts latencies in [2^i, 2^(i+1)) usec,
+   bucket 0 also counts everything below 1 usec */
+#define HULLD_NBUCKETS 32
+
+typedef struct _hulld_request {
+  unsigned int magic;
+  int op;
+  char shm_name[64];  /* segment with the points, for HULLD_OP_HULL */
+  long n;             /* number of points in it */
+} hulld_request;
+
+typedef struct _hulld_reply {
+  int status;
+  long h;             /* number of hull indices written after the points */
+  double usec;        /* time the daemon spent on the request */
+  long hist[HULLD_NBUCKETS];  /* for HULLD_OP_STATS */
+} hulld_reply;
+
+
+/* size of a segment that holds a batch of n points */
+size_t hulld_segment_size(long n);
+
+/* the hull indices in a segment of n points */
+int* hulld_segment_indices(void* segment, long n);
+
+/* reads/writes exactly len bytes; returns 0 on error or end of file */
+int read_full(int fd, void* buf, size_t len);
+int write_full(int fd, const void* buf, size_t len);
+
+/* adds a latency of usec microseconds to hist */
+void hist_add(long* hist, double usec);
+
+/* returns the upper bound, in usec, of the bucket that holds the p-th
+   percentile of hist */
+double hist_percentile(const long* hist, double p);
+
+/* prints the non-empty buckets of hist, and the main percentiles */
+void hist_print(FILE* f, const long* hist);
+
+
+#endif
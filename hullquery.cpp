@@ -0,0 +1,240 @@
+#include "hullquery.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vector>
+
+using namespace std;
+
+
+/* **************************************** */
+/* returns 0 if the angle of vector v is in [0, pi), 1 if it is in [pi, 2pi) */
+static int half_plane(point2d v) {
+  return (v.y > 0 || (v.y == 0 && v.x > 0)) ? 0 : 1;
+}
+
+/* return 1 if the angle of vector u (measured CCW from the positive
+   x-axis, in [0, 2pi)) is strictly smaller than the angle of v */
+static int angle_less(point2d u, point2d v) {
+  int hu = half_plane(u);
+  int hv = half_plane(v);
+  if (hu != hv) return hu < hv;
+  point2d origin = {0, 0};
+  return left_strictly(origin, u, v);
+}
+
+
+/* **************************************** */
+/*
+  the edges hull[i] -> hull[i+1] for i in [0, h-1) have strictly
+  increasing angles in (0, 2pi) because hull[0] is the bottom point.
+  the vertex extreme in direction d is the first vertex whose outgoing
+  edge turns past the direction perpendicular to d (d rotated by 90
+  degrees CCW), so we binary search for that edge. if no edge does,
+  the extreme vertex is hull[h-1] or it wraps around to hull[0]
+*/
+int hull_extreme_point(const vector<point2d>& hull, point2d d) {
+  int h = hull.size();
+  if (h == 0) return -1;
+  if (h == 1 || (d.x == 0 && d.y == 0)) return 0;
+
+  point2d perp;
+  perp.x = -d.y;
+  perp.y = d.x;
+
+  //find the first edge i in [0, h-1) with angle > angle(perp)
+  int lo = 0, hi = h - 1;
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    point2d e;
+    e.x = hull[mid+1].x - hull[mid].x;
+    e.y = hull[mid+1].y - hull[mid].y;
+    if (angle_less(perp, e)) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  if (lo < h - 1) return lo;
+
+  //the last edge goes back to hull[0]; its angle is in (pi, 2pi], where
+  //2pi (pointing along the positive x-axis) compares as 0 in angle_less
+  point2d e;
+  e.x = hull[0].x - hull[h-1].x;
+  e.y = hull[0].y - hull[h-1].y;
+  if ((e.y == 0 && e.x > 0) || angle_less(perp, e)) return h - 1;
+  return 0;
+}
+
+
+/* **************************************** */
+void hull_extreme_points(const vector<point2d>& hull, const vector<point2d>& dirs,
+                         vector<int>& result) {
+  result.resize(dirs.size());
+  for (int i = 0; i < (int)dirs.size(); i++) {
+    result[i] = hull_extreme_point(hull, dirs[i]);
+  }
+}
+
+
+/* **************************************** */
+/* return 1 if q is on the segment ab (a,b,q collinear); 0 otherwise */
+static int on_segment(point2d a, point2d b, point2d q) {
+  if (!collinear(a, b, q)) return 0;
+  return (q.x >= min(a.x, b.x)) && (q.x <= max(a.x, b.x))
+    && (q.y >= min(a.y, b.y)) && (q.y <= max(a.y, b.y));
+}
+
+
+/* **************************************** */
+/*
+  the hull is a fan of triangles around hull[0]; binary search for the
+  wedge containing q, then test against the one hull edge that closes it
+*/
+int hull_contains(const vector<point2d>& hull, point2d q) {
+  int h = hull.size();
+  if (h == 0) return 0;
+  if (h == 1) return (hull[0].x == q.x && hull[0].y == q.y);
+  if (h == 2) return on_segment(hull[0], hull[1], q);
+
+  point2d p0 = hull[0];
+  //q must be inside the wedge at p0 spanned by hull[1] and hull[h-1]
+  if (!left_on(p0, hull[1], q)) return 0;
+  if (left_strictly(p0, hull[h-1], q)) return 0;
+
+  //find the last i in [1, h-1] such that q is left of or on p0 -> hull[i]
+  int lo = 1, hi = h - 1;
+  while (lo < hi) {
+    int mid = lo + (hi - lo + 1) / 2;
+    if (left_on(p0, hull[mid], q)) {
+      lo = mid;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  if (lo == h - 1) {
+    //q is on the ray from p0 through hull[h-1]
+    return on_segment(p0, hull[h-1], q);
+  }
+  return left_on(hull[lo], hull[lo+1], q);
+}
+
+
+/* **************************************** */
+/*
+  returns the smallest i in [lo, hi) such that hull[i+1] does NOT turn
+  strictly in direction dir (1 = left, -1 = right) as seen from q, i.e.
+  such that dir * signed_area2D(q, hull[i], hull[i+1]) <= 0. indices
+  wrap around, so hull[h] is hull[0]. returns hi if there is none. the
+  turns must be true on a prefix of [lo, hi) and false after it
+*/
+static int first_not_turning(const vector<point2d>& hull, point2d q, int lo, int hi, int dir) {
+  int h = hull.size();
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    if (dir * signed_area2D(q, hull[mid], hull[(mid+1) % h]) > 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+
+/* returns -1, 0 or 1 according to the side of the line q -> p0 that p is on */
+static int side(point2d q, point2d p0, point2d p) {
+  long long a = signed_area2D(q, p0, p);
+  return (a > 0) - (a < 0);
+}
+
+
+/* **************************************** */
+/*
+  the line through q and hull[0] splits the hull into two contiguous
+  chains: the vertices left of it and the vertices right of it. as seen
+  from q, the angle of the vertices increases then decreases along the
+  left chain, and decreases then increases along the right chain, so
+  each tangent is the turning point of one chain and can be found by
+  binary search
+*/
+int hull_tangents(const vector<point2d>& hull, point2d q, int* ileft, int* iright) {
+  int h = hull.size();
+  if (hull_contains(hull, q)) return 0;
+  if (h == 1) {
+    *ileft = *iright = 0;
+    return 1;
+  }
+  if (h == 2) {
+    long long a = signed_area2D(q, hull[0], hull[1]);
+    if (a > 0) {
+      *iright = 0; *ileft = 1;
+    } else if (a < 0) {
+      *iright = 1; *ileft = 0;
+    } else {
+      //q is on the line through the segment: both tangents are the nearer endpoint
+      int d0 = abs(hull[0].x - q.x) + abs(hull[0].y - q.y);
+      int d1 = abs(hull[1].x - q.x) + abs(hull[1].y - q.y);
+      *ileft = *iright = (d0 <= d1) ? 0 : 1;
+    }
+    return 1;
+  }
+
+  point2d p0 = hull[0];
+  int s1 = side(q, p0, hull[1]);
+
+  //find k, the first index in [1, h) on a different side than hull[1]
+  int lo = 1, hi = h;
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    if (side(q, p0, hull[mid]) == s1) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  int k = lo;
+
+  if (s1 == 0) {
+    //hull[1] is on the line; all the other vertices are on one side of it
+    int s2 = side(q, p0, hull[2]);
+    if (s2 > 0) {
+      *ileft = first_not_turning(hull, q, 1, h, 1);
+      *iright = 0;
+    } else {
+      *iright = first_not_turning(hull, q, 1, h, -1);
+      *ileft = 0;
+    }
+    return 1;
+  }
+
+  //the chain [0, k) is on side s1; find its turning point, then the
+  //turning point of the rest of the hull [k-1, h), if it has vertices
+  //strictly on the other side
+  int other_side = (k < h) && (side(q, p0, hull[k]) == -s1
+                               || (k + 1 < h && side(q, p0, hull[k+1]) == -s1));
+  int first = first_not_turning(hull, q, 0, k, s1);
+  int second = other_side ? first_not_turning(hull, q, k - 1, h, -s1) : 0;
+  if (s1 > 0) {
+    *ileft = first;
+    *iright = second;
+  } else {
+    *iright = first;
+    *ileft = second;
+  }
+  return 1;
+}
+
+
+/* **************************************** */
+void hull_tangents(const vector<point2d>& hull, const vector<point2d>& qs,
+                   vector<int>& ileft, vector<int>& iright) {
+  ileft.resize(qs.size());
+  iright.resize(qs.size());
+  for (int i = 0; i < (int)qs.size(); i++) {
+    if (!hull_tangents(hull, qs[i], &ileft[i], &iright[i])) {
+      ileft[i] = iright[i] = -1;
+    }
+  }
+}
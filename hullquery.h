@@ -0,0 +1,54 @@
+#ifndef __hullquery_h
+#define __hullquery_h
+
+#include "geom.h"
+
+#include <vector>
+
+using namespace std;
+
+
+/*
+  queries on a convex hull as produced by build_hull(): the vertices are
+  in CCW order, hull[0] is the bottom point (rightmost if tied) and there
+  are no three collinear vertices. all queries run in O(log h)
+*/
+
+
+/*
+  returns the index of the hull vertex that is extreme in direction d,
+  i.e. the vertex maximizing the dot product with d. if an edge is
+  perpendicular to d the later of its two endpoints (in CCW order) is
+  returned. returns 0 if d is (0,0) and -1 if the hull is empty
+*/
+int hull_extreme_point(const vector<point2d>& hull, point2d d);
+
+/*
+  batch version of hull_extreme_point(): result[i] is the index of the
+  vertex extreme in direction dirs[i]
+*/
+void hull_extreme_points(const vector<point2d>& hull, const vector<point2d>& dirs,
+                         vector<int>& result);
+
+/* return 1 if q is inside the hull or on its boundary; 0 otherwise */
+int hull_contains(const vector<point2d>& hull, point2d q);
+
+/*
+  finds the two tangents from q to the hull.
+  the whole hull is left of or on the line from q through hull[*iright],
+  and right of or on the line from q through hull[*ileft].
+  returns 1 if q is outside the hull, and 0 (leaving *ileft and *iright
+  untouched) if q is inside or on the boundary
+*/
+int hull_tangents(const vector<point2d>& hull, point2d q, int* ileft, int* iright);
+
+/*
+  batch version of hull_tangents(): for every query point qs[i], stores
+  the tangent indices in ileft[i] and iright[i], or -1 in both if qs[i]
+  is inside or on the hull
+*/
+void hull_tangents(const vector<point2d>& hull, const vector<point2d>& qs,
+                   vector<int>& ileft, vector<int>& iright);
+
+
+#endif
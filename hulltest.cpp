@@ -0,0 +1,315 @@
+/* hulltest.cpp
+
+   Regression tests: small inputs on which a hull routine once gave a
+   wrong answer, plus random inputs of the same kind checked against
+   graham_scan_inplace(). Prints every failed check and exits 1 if there
+   was any.
+
+   usage: hulltest        (or "make test")
+*/
+
+#include "geom.h"
+#include "geomf.h"
+#include "melkman.h"
+#include "hullpair.h"
+#include "kinetichull.h"
+#include "calipers.h"
+#include "hullupdate.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#include <vector>
+#include <algorithm>
+using namespace std;
+
+
+static int nchecks = 0, nfailed = 0;
+
+/* counts a check, and prints it if it failed */
+static void check(int ok, const char* what) {
+  nchecks++;
+  if (ok) return;
+  nfailed++;
+  printf("FAIL: %s\n", what);
+}
+
+static int same_hull(const vector<point2d>& a, const vector<point2d>& b) {
+  if (a.size() != b.size()) return 0;
+  for (size_t i = 0; i < a.size(); i++) {
+    if (a[i].x != b[i].x || a[i].y != b[i].y) return 0;
+  }
+  return 1;
+}
+
+static vector<point2d> make_points(const int* xy, int n) {
+  vector<point2d> p(n);
+  for (int i = 0; i < n; i++) {
+    p[i].x = xy[2*i];
+    p[i].y = xy[2*i+1];
+  }
+  return p;
+}
+
+
+/* ****************************** */
+static void test_melkman() {
+  vector<point2d> hull;
+
+  //popping stopped one vertex early and kept (4,1) on the hull
+  int line[] = {2,0, 4,1, 7,4, 9,2};
+  int line_hull[] = {2,0, 9,2, 7,4};
+  melkman_hull_unchecked(make_points(line, 4), hull);
+  check(same_hull(hull, make_points(line_hull, 3)), "melkman: (2,0),(4,1),(7,4),(9,2)");
+
+  //x-monotone polylines are simple: Melkman alone must be right, and
+  //melkman_hull() must not fall back
+  int wrong = 0, fell_back = 0;
+  srand(1);
+  for (int t = 0; t < 20000; t++) {
+    int n = 3 + rand() % 30, x = 0;
+    vector<point2d> pts(n);
+    for (int i = 0; i < n; i++) {
+      x += 1 + rand() % 4;
+      pts[i].x = x;
+      pts[i].y = rand() % 20;
+    }
+    if (t & 1) reverse(pts.begin(), pts.end());
+    vector<point2d> expected = pts;
+    graham_scan_inplace(expected);
+    melkman_hull_unchecked(pts, hull);
+    if (!same_hull(hull, expected)) wrong++;
+    if (!melkman_hull(pts, hull)) fell_back++;
+  }
+  check(wrong == 0, "melkman: random x-monotone polylines");
+  check(fell_back == 0, "melkman: no fallback on x-monotone polylines");
+}
+
+
+/* ****************************** */
+/* intersects a with b, both ways, and checks that it is exactly the
+   points of want */
+static void check_intersection(const int* a, int na, const int* b, int nb,
+                               const double* want, int nwant, const char* what) {
+  vector<point2d> ha = make_points(a, na), hb = make_points(b, nb);
+  for (int swapped = 0; swapped < 2; swapped++) {
+    vector<fpoint2d> out;
+    if (swapped) hull_intersection(hb, ha, out);
+    else hull_intersection(ha, hb, out);
+    int ok = (int)out.size() == nwant;
+    for (int i = 0; ok && i < nwant; i++) {
+      if (fabs(out[i].x - want[2*i]) > 1e-9 || fabs(out[i].y - want[2*i+1]) > 1e-9) ok = 0;
+    }
+    check(ok, what);
+  }
+}
+
+static void test_hull_intersection() {
+  //intersections that are segments lost their far end: whatever the
+  //slope, inside, across, or along a shared edge
+  int square[] = {0,0, 10,0, 10,10, 0,10};
+  int up[] = {3,3, 7,7};
+  double up_want[] = {3,3, 7,7};
+  check_intersection(square, 4, up, 2, up_want, 2, "intersection: segment inside, slope 1");
+  int down[] = {7,3, 3,7};
+  double down_want[] = {7,3, 3,7};
+  check_intersection(square, 4, down, 2, down_want, 2, "intersection: segment inside, slope -1");
+  int across[] = {-2,-1, 12,6};
+  double across_want[] = {0,0, 10,5};
+  check_intersection(square, 4, across, 2, across_want, 2, "intersection: segment across, slope 1/2");
+  int across_down[] = {12,-1, -2,6};
+  double across_down_want[] = {10,0, 0,5};
+  check_intersection(square, 4, across_down, 2, across_down_want, 2,
+                     "intersection: segment across, slope -1/2");
+
+  int below[] = {0,0, 10,0, 10,10};
+  int above[] = {0,0, 10,10, 0,10};
+  double diagonal[] = {0,0, 10,10};
+  check_intersection(below, 3, above, 3, diagonal, 2, "intersection: shared edge, slope 1");
+  int below_down[] = {10,0, 10,10, 0,10};
+  int above_down[] = {0,0, 10,0, 0,10};
+  double antidiagonal[] = {10,0, 0,10};
+  check_intersection(below_down, 3, above_down, 3, antidiagonal, 2,
+                     "intersection: shared edge, slope -1");
+
+  //the crossings of a segment are rounded, and then lo was above hi
+  int kite[] = {0,0, 5,2, 4,4, 2,5};
+  int cut[] = {2,0, -2,4};
+  double cut_want[] = {10.0/7, 4.0/7, 4.0/7, 10.0/7};
+  check_intersection(kite, 4, cut, 2, cut_want, 2, "intersection: segment across, rounded");
+  vector<point2d> hk = make_points(kite, 4), hc = make_points(cut, 2);
+  check(hull_overlap(hk, hc), "overlap: segment across, rounded");
+
+  int corner[] = {10,10, 20,10, 20,20};
+  double corner_want[] = {10,10};
+  check_intersection(square, 4, corner, 3, corner_want, 1, "intersection: shared corner");
+  int apart[] = {11,0, 12,5};
+  check_intersection(square, 4, apart, 2, NULL, 0, "intersection: apart");
+}
+
+
+/* ****************************** */
+/* moves the points, bouncing in [0, 512]^2, and compares the kinetic
+   hull with graham_scan() at every step. the positions, velocities and
+   times are multiples of powers of 2, so the positions are exact and
+   collinear points stay exactly collinear */
+static void check_kinetic(const vector<fpoint2d>& pos, const vector<fpoint2d>& vel,
+                          int steps, const char* what) {
+  int n = pos.size(), wrong = 0;
+  kinetic_hull k;
+  kinetic_hull_init(&k, pos, vel, 0);
+  vector<fpoint2d> now(n), hull, expected;
+  for (int s = 1; s <= steps; s++) {
+    kinetic_hull_advance(&k, s / 64.0);
+    for (int i = 0; i < n; i++) {
+      fpoint2d p = kinetic_hull_position(&k, i);
+      fpoint2d v = {k.pts[i].vx, k.pts[i].vy};
+      int bounce = 0;
+      if ((p.x < 0 && v.x < 0) || (p.x > 512 && v.x > 0)) {
+        v.x = -v.x;
+        bounce = 1;
+      }
+      if ((p.y < 0 && v.y < 0) || (p.y > 512 && v.y > 0)) {
+        v.y = -v.y;
+        bounce = 1;
+      }
+      if (bounce) kinetic_hull_set_velocity(&k, i, v);
+      now[i] = kinetic_hull_position(&k, i);
+    }
+    kinetic_hull_get(&k, hull);
+    graham_scan(now, expected);
+    int same = hull.size() == expected.size();
+    for (size_t j = 0; same && j < hull.size(); j++) {
+      if (hull[j].x != expected[j].x || hull[j].y != expected[j].y) same = 0;
+    }
+    if (!same) wrong++;
+  }
+  check(wrong == 0, what);
+}
+
+static void test_kinetic_hull() {
+  //zero turns on the hull were kept as vertices
+  int n = 60, steps = 20000;
+  vector<fpoint2d> pos(n), vel(n);
+  srand(2);
+  for (int i = 0; i < n; i++) {
+    pos[i].x = pos[i].y = 256;
+    vel[i].x = (rand() % 81 - 40) / 4.0;
+    vel[i].y = (rand() % 81 - 40) / 4.0;
+  }
+  check_kinetic(pos, vel, steps, "kinetic: shared start");
+
+  for (int i = 0; i < n; i++) {
+    pos[i].x = 64 * (i % 8);
+    pos[i].y = 64 * (i / 8);
+  }
+  check_kinetic(pos, vel, steps, "kinetic: grid start");
+
+  for (int i = 0; i < n; i++) {
+    pos[i].x = rand() % 512;
+    pos[i].y = rand() % 512;
+    if (i % 3) {
+      vel[i].x = 5;
+      vel[i].y = -3;
+    }
+  }
+  check_kinetic(pos, vel, steps, "kinetic: equal velocities");
+
+  //on a line, and moving along it until they bounce
+  for (int i = 0; i < n; i++) {
+    pos[i].x = 4 * i;
+    pos[i].y = 8 * i;
+    vel[i].x = (i % 4) - 1.5;
+    vel[i].y = 2 * vel[i].x;
+  }
+  check_kinetic(pos, vel, steps, "kinetic: collinear");
+}
+
+
+/* ****************************** */
+static void test_calipers() {
+  //the width and rectangle comparisons overflowed for coordinates near
+  //2^30: check them against every edge, in long double
+  int wrong_width = 0, wrong_rect = 0;
+  srand(3);
+  for (int t = 0; t < 2000; t++) {
+    int n = 3 + rand() % 40;
+    double squash = 0.2 + (rand() % 81) / 100.0;
+    vector<point2d> hull(n);
+    for (int i = 0; i < n; i++) {
+      double a = 2 * M_PI * rand() / RAND_MAX;
+      hull[i].x = (int)(1.07e9 * cos(a));
+      hull[i].y = (int)(1.07e9 * squash * sin(a));
+    }
+    graham_scan_inplace(hull);
+    int h = hull.size();
+    if (h < 3) continue;
+    hull_measures m;
+    hull_measure_all(hull, &m);
+
+    long double width = HUGE_VALL, area = HUGE_VALL;
+    for (int i = 0; i < h; i++) {
+      point2d a = hull[i], b = hull[(i+1) % h];
+      long double ex = (long double)b.x - a.x, ey = (long double)b.y - a.y;
+      long double len = sqrtl(ex * ex + ey * ey);
+      long double top = 0, lo = HUGE_VALL, hi = -HUGE_VALL;
+      for (int j = 0; j < h; j++) {
+        long double dx = (long double)hull[j].x - a.x, dy = (long double)hull[j].y - a.y;
+        top = max(top, (ex * dy - ey * dx) / len);
+        lo = min(lo, (ex * dx + ey * dy) / len);
+        hi = max(hi, (ex * dx + ey * dy) / len);
+      }
+      width = min(width, top);
+      area = min(area, top * (hi - lo));
+    }
+    if (fabsl(m.width - width) > 1e-12 * width) wrong_width++;
+    if (fabsl(m.rect_area - area) > 1e-12 * area) wrong_rect++;
+  }
+  check(wrong_width == 0, "calipers: width near 2^30");
+  check(wrong_rect == 0, "calipers: rectangle near 2^30");
+}
+
+
+/* ****************************** */
+static point2d random_in_disk(double r) {
+  double a = 2 * M_PI * rand() / RAND_MAX, d = r * sqrt((double)rand() / RAND_MAX);
+  point2d p = {(int)(d * cos(a)), (int)(d * sin(a))};
+  return p;
+}
+
+static void test_hull_update() {
+  //the angles around the anchor, at 3 times the coordinates, overflowed
+  //near 2^30
+  srand(5);
+  vector<point2d> pts(2000), all, expected;
+  for (size_t i = 0; i < pts.size(); i++) pts[i] = random_in_disk(1.07e9);
+  hull_state hs;
+  hull_state_init(&hs, pts);
+  int wrong = 0;
+  for (int step = 0; step < 300; step++) {
+    vector<point2d> added(20), removed;
+    for (size_t i = 0; i < added.size(); i++) added[i] = random_in_disk(1.07e9);
+    hull_state_points(&hs, all);
+    for (int i = 0; i < 10; i++) removed.push_back(all[rand() % all.size()]);
+    update_hull(&hs, added, removed);
+    hull_state_points(&hs, expected);
+    graham_scan_inplace(expected);
+    if (!same_hull(hs.hull, expected)) wrong++;
+  }
+  check(wrong == 0, "hull update: near 2^30");
+}
+
+
+/* ****************************** */
+int main(int argc, char** argv) {
+
+  test_melkman();
+  test_hull_intersection();
+  test_kinetic_hull();
+  test_calipers();
+  test_hull_update();
+
+  printf("%d checks, %d failed\n", nchecks, nfailed);
+  return nfailed ? 1 : 0;
+}
@@ -0,0 +1,116 @@
+/* hulltext.cpp
+
+   Hull of a text file of points (see pointtext.h for the format),
+   parsed in parallel.
+
+   By default the points are read into memory with read_points_text()
+   and the hull is computed with graham_scan_inplace(). With -s the
+   file is streamed instead: every thread parses its slice in chunks
+   and keeps only the hull of what it has read, so the parse and the
+   hull overlap and the points are never stored. Either way the time
+   and the allocations of every phase are printed (hrtimer.h).
+
+   usage: hulltext [-t nthreads] [-s chunk] [-o hull.bin] points.txt
+          hulltext -g npoints points.txt     (writes random points)
+*/
+
+#include "geom.h"
+#include "pointtext.h"
+#include "rtimer.h"
+#include "hrtimer.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <assert.h>
+#include <unistd.h>
+
+#include <vector>
+using namespace std;
+
+
+/* ****************************** */
+static void usage(const char* prog) {
+  printf("usage: %s [-t nthreads] [-s chunk] [-o hull.bin] points.txt\n", prog);
+  printf("       %s -g npoints points.txt\n", prog);
+  exit(1);
+}
+
+static void print_parse(const char* what, const text_parse_stats* st) {
+  printf("%s: %ld points, %ld bad lines, %.1f MB in %.3f s (%.2f GB/s)\n", what,
+         st->points, st->bad_lines, st->bytes / 1e6, st->seconds,
+         st->seconds > 0 ? st->bytes / st->seconds / 1e9 : 0);
+}
+
+
+/* ****************************** */
+int main(int argc, char** argv) {
+
+  int nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+  int chunk = 0;
+  long generate = 0;
+  const char* out_path = NULL;
+
+  int c;
+  while ((c = getopt(argc, argv, "t:s:o:g:")) != -1) {
+    switch (c) {
+    case 't': nthreads = atoi(optarg); break;
+    case 's': chunk = atoi(optarg); break;
+    case 'o': out_path = optarg; break;
+    case 'g': generate = atol(optarg); break;
+    default: usage(argv[0]);
+    }
+  }
+  if (optind != argc - 1) usage(argv[0]);
+  const char* path = argv[optind];
+
+  if (generate > 0) {
+    //in [0, 2^30)^2, the range in which signed_area2D() is exact
+    vector<point2d> pts(generate);
+    for (long i = 0; i < generate; i++) {
+      pts[i].x = random() % (1 << 30);
+      pts[i].y = random() % (1 << 30);
+    }
+    return write_points_text(path, pts) ? 0 : 1;
+  }
+  assert(nthreads > 0);
+  printf("hulltext: %d threads\n", nthreads);
+
+  vector<point2d> hull;
+  text_parse_stats st;
+  char buf[1024];
+  //the phases of this thread, with the allocations of all the threads
+  hrt_enable(1);
+  hrt_set_options(HRT_MEMORY);
+  if (chunk > 0) {
+    {
+      HRT_SCOPE("parse + hull");
+      if (hull_of_text_file(path, hull, nthreads, chunk, &st) < 0) exit(1);
+    }
+    print_parse("parse + hull", &st);
+  } else {
+    {
+      HRT_SCOPE("parse");
+      if (read_points_text(path, hull, nthreads, &st) < 0) exit(1);
+    }
+    print_parse("parse", &st);
+    Rtimer rt;
+    rt_start(rt);
+    graham_scan_inplace(hull);
+    rt_stop(rt);
+    rt_sprint(buf, rt);
+    printf("hull time: %s\n", buf);
+  }
+  hrt_print_tree(stdout);
+  printf("hull: %lu points\n", hull.size());
+
+  if (out_path) {
+    FILE* f = fopen(out_path, "wb");
+    if (!f) {
+      perror(out_path);
+      exit(1);
+    }
+    fwrite(hull.data(), sizeof(point2d), hull.size(), f);
+    fclose(f);
+  }
+  return 0;
+}
@@ -0,0 +1,331 @@
+#include "hullupdate.h"
+#include "hullquery.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vector>
+#include <set>
+#include <algorithm>
+
+using namespace std;
+
+
+/* **************************************** */
+/* p relative to the anchor, times 3. the anchor itself is given the
+   direction of the positive x-axis, so it always falls in the same
+   bucket no matter where the hull starts */
+static inline void anchor_rel(const hull_state* hs, point2d p, long long* dx, long long* dy) {
+  *dx = 3LL * p.x - hs->cx3;
+  *dy = 3LL * p.y - hs->cy3;
+  if (*dx == 0 && *dy == 0) *dx = 1;
+}
+
+/* 0 if the angle from (rx,ry) to (dx,dy), CCW, is in [0, pi); 1 otherwise.
+   the vectors are 3 times the coordinates, so the products need 128 bits */
+static int rel_half(long long rx, long long ry, long long dx, long long dy) {
+  __int128 cr = (__int128)rx * dy - (__int128)ry * dx;
+  return (cr > 0 || (cr == 0 && (__int128)rx * dx + (__int128)ry * dy > 0)) ? 0 : 1;
+}
+
+/*
+  finds the bucket of p: the last hull vertex whose angle around the
+  anchor, measured CCW from hull[0], is <= the angle of p. the angles
+  of the vertices increase from 0 along the hull because the anchor is
+  strictly inside it
+*/
+static int locate(const hull_state* hs, point2d p) {
+  const vector<point2d>& hull = hs->hull;
+  long long rx, ry, dx, dy;
+  anchor_rel(hs, hull[0], &rx, &ry);
+  anchor_rel(hs, p, &dx, &dy);
+  int hp = rel_half(rx, ry, dx, dy);
+
+  int lo = 0, hi = hull.size() - 1;
+  while (lo < hi) {
+    int mid = lo + (hi - lo + 1) / 2;
+    long long vx, vy;
+    anchor_rel(hs, hull[mid], &vx, &vy);
+    int hv = rel_half(rx, ry, vx, vy);
+    int leq = (hv != hp) ? (hv < hp) : ((__int128)vx * dy - (__int128)vy * dx >= 0);
+    if (leq) {
+      lo = mid;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  return lo;
+}
+
+/* return 1 if the anchor is strictly left of uv */
+static int anchor_left_of(const hull_state* hs, point2d u, point2d v) {
+  long long ex = 3LL * v.x - 3LL * u.x, ey = 3LL * v.y - 3LL * u.y;
+  long long ax = hs->cx3 - 3LL * u.x, ay = hs->cy3 - 3LL * u.y;
+  return (__int128)ex * ay - (__int128)ey * ax > 0;
+}
+
+
+/* **************************************** */
+/* all the points of the set */
+void hull_state_points(const hull_state* hs, vector<point2d>& pts) {
+  pts.clear();
+  if (hs->hull.size() < 3) {
+    pts = hs->flat;
+    return;
+  }
+  pts.insert(pts.end(), hs->hull.begin(), hs->hull.end());
+  for (size_t i = 0; i < hs->bucket.size(); i++) {
+    pts.insert(pts.end(), hs->bucket[i].begin(), hs->bucket[i].end());
+  }
+}
+
+long hull_state_size(const hull_state* hs) {
+  return hs->n;
+}
+
+/* recomputes everything from the points in all */
+static void rebuild(hull_state* hs, const vector<point2d>& all) {
+  hs->nfull++;
+  hs->n = all.size();
+  hs->hull = all;
+  graham_scan_inplace(hs->hull);
+  hs->bucket.clear();
+  hs->flat.clear();
+
+  int h = hs->hull.size();
+  if (h < 3) {
+    //no anchor strictly inside
+    hs->flat = all;
+    return;
+  }
+  //three vertices far apart along the hull, so that the anchor is well
+  //inside and survives more vertex removals
+  point2d a = hs->hull[0], b = hs->hull[h / 3], c = hs->hull[2 * h / 3];
+  hs->cx3 = (long long)a.x + b.x + c.x;
+  hs->cy3 = (long long)a.y + b.y + c.y;
+
+  hs->bucket.resize(h);
+  for (size_t i = 0; i < all.size(); i++) {
+    hs->bucket[locate(hs, all[i])].insert(all[i]);
+  }
+  //the hull vertices are not in the buckets
+  for (int i = 0; i < h; i++) {
+    point_bucket::iterator it = hs->bucket[i].find(hs->hull[i]);
+    assert(it != hs->bucket[i].end());
+    hs->bucket[i].erase(it);
+  }
+}
+
+void hull_state_init(hull_state* hs, const vector<point2d>& pts) {
+  hs->nlocal = hs->npartial = hs->nfull = 0;
+  rebuild(hs, pts);
+}
+
+
+/* **************************************** */
+/*
+  replaces the vertices strictly between hull[i] and hull[j] (going
+  CCW) by the vertices in mid. the removed vertices and the points in
+  the buckets of the replaced edges are appended to pool; the caller
+  puts them back in buckets with distribute(). the hull is rotated so
+  that it starts at the bottom point again
+*/
+static void splice(hull_state* hs, int i, int j, const vector<point2d>& mid,
+                   vector<point2d>& pool) {
+  int h = hs->hull.size();
+  for (int k = i; k != j; k = (k + 1) % h) {
+    if (k != i) pool.push_back(hs->hull[k]);
+    pool.insert(pool.end(), hs->bucket[k].begin(), hs->bucket[k].end());
+  }
+
+  vector<point2d> nh;
+  vector<point_bucket> nb;
+  for (int k = j; k != i; k = (k + 1) % h) {
+    nh.push_back(hs->hull[k]);
+    nb.push_back(point_bucket());
+    nb.back().swap(hs->bucket[k]);
+  }
+  nh.push_back(hs->hull[i]);
+  nb.push_back(point_bucket());
+  for (size_t k = 0; k < mid.size(); k++) {
+    nh.push_back(mid[k]);
+    nb.push_back(point_bucket());
+  }
+
+  //bottom point first, rightmost if tied
+  int b = 0;
+  for (int k = 1; k < (int)nh.size(); k++) {
+    if (nh[k].y < nh[b].y || (nh[k].y == nh[b].y && nh[k].x > nh[b].x)) b = k;
+  }
+  rotate(nh.begin(), nh.begin() + b, nh.end());
+  rotate(nb.begin(), nb.begin() + b, nb.end());
+  hs->hull.swap(nh);
+  hs->bucket.swap(nb);
+}
+
+static void distribute(hull_state* hs, const vector<point2d>& pool) {
+  for (size_t k = 0; k < pool.size(); k++) {
+    hs->bucket[locate(hs, pool[k])].insert(pool[k]);
+  }
+}
+
+
+/* **************************************** */
+static void add_point(hull_state* hs, point2d p) {
+  hs->n++;
+  hs->nlocal++;
+  int il, ir;
+  if (!hull_tangents(hs->hull, p, &il, &ir)) {
+    hs->bucket[locate(hs, p)].insert(p);
+    return;
+  }
+
+  //p replaces the chain it sees, from il to ir. a tangent vertex that
+  //ends up collinear with p and its other neighbour is dropped too
+  const vector<point2d>& hull = hs->hull;
+  int h = hull.size();
+  while (!left_strictly(hull[(il + h - 1) % h], hull[il], p)) il = (il + h - 1) % h;
+  while (!left_strictly(p, hull[ir], hull[(ir + 1) % h])) ir = (ir + 1) % h;
+
+  vector<point2d> mid(1, p), pool;
+  splice(hs, il, ir, mid, pool);
+  distribute(hs, pool);
+}
+
+
+/* orders the points right of a line through a by CCW angle around a,
+   the nearer first if they are collinear with a */
+struct around_less {
+  point2d a;
+  bool operator()(const point2d& u, const point2d& v) const {
+    long long ux = (long long)u.x - a.x, uy = (long long)u.y - a.y;
+    long long vx = (long long)v.x - a.x, vy = (long long)v.y - a.y;
+    long long cr = ux * vy - uy * vx;
+    if (cr != 0) return cr > 0;
+    return ux * ux + uy * uy < vx * vx + vy * vy;
+  }
+};
+
+/* returns 0 if p is not in the set */
+static int remove_point(hull_state* hs, point2d p) {
+  int i = locate(hs, p);
+  point_bucket::iterator it = hs->bucket[i].find(p);
+  if (it != hs->bucket[i].end()) {
+    //not a hull vertex, or a copy of one
+    hs->bucket[i].erase(it);
+    hs->n--;
+    hs->nlocal++;
+    return 1;
+  }
+  if (hs->hull[i].x != p.x || hs->hull[i].y != p.y) return 0;
+
+  //p is the hull vertex i. the new chain from its previous vertex a to
+  //its next vertex b lies in the triangle a p b, so its vertices are
+  //in the buckets of the two edges of p, strictly right of ab
+  const vector<point2d>& hull = hs->hull;
+  int h = hull.size();
+  int ia = (i + h - 1) % h, ib = (i + 1) % h;
+  point2d a = hull[ia], b = hull[ib];
+  vector<point2d> cand;
+  for (int k = 0; k < 2; k++) {
+    const point_bucket& bk = hs->bucket[k ? i : ia];
+    for (point_bucket::const_iterator q = bk.begin(); q != bk.end(); ++q) {
+      if (signed_area2D(a, b, *q) < 0) cand.push_back(*q);
+    }
+  }
+  //graham scan from a: by angle around a, nearer first if collinear
+  around_less less;
+  less.a = a;
+  sort(cand.begin(), cand.end(), less);
+  cand.push_back(b);
+  vector<point2d> chain(1, a);
+  for (size_t k = 0; k < cand.size(); k++) {
+    while (chain.size() >= 2 && !left_strictly(chain[chain.size() - 2], chain.back(), cand[k])) {
+      chain.pop_back();
+    }
+    chain.push_back(cand[k]);
+  }
+
+  //if the anchor fell out of the hull, the other buckets are no longer
+  //wedges of the hull: start over
+  int inside = 1;
+  for (size_t k = 0; k + 1 < chain.size(); k++) {
+    if (!anchor_left_of(hs, chain[k], chain[k + 1])) inside = 0;
+  }
+  if (!inside) {
+    vector<point2d> all;
+    hull_state_points(hs, all);
+    for (size_t k = 0; k < all.size(); k++) {
+      if (all[k].x == p.x && all[k].y == p.y) {
+        all[k] = all.back();
+        all.pop_back();
+        break;
+      }
+    }
+    rebuild(hs, all);
+    return 1;
+  }
+
+  hs->npartial++;
+  hs->n--;
+  vector<point2d> mid(chain.begin() + 1, chain.end() - 1), pool;
+  splice(hs, ia, ib, mid, pool);
+  //p itself was put in the pool as a removed vertex
+  for (size_t k = 0; k < pool.size(); k++) {
+    if (pool[k].x == p.x && pool[k].y == p.y) {
+      pool[k] = pool.back();
+      pool.pop_back();
+      break;
+    }
+  }
+  distribute(hs, pool);
+  //the new vertices came from the buckets, and went back into them
+  for (size_t k = 0; k < mid.size(); k++) {
+    point_bucket& bk = hs->bucket[locate(hs, mid[k])];
+    point_bucket::iterator it = bk.find(mid[k]);
+    assert(it != bk.end());
+    bk.erase(it);
+  }
+  return 1;
+}
+
+
+/* **************************************** */
+int update_hull(hull_state* hs, const vector<point2d>& added, const vector<point2d>& removed) {
+  int missing = 0;
+  //while the hull is degenerate the points are kept in flat, and the
+  //hull is recomputed once at the end
+  int dirty = 0;
+
+  for (size_t k = 0; k < removed.size(); k++) {
+    point2d p = removed[k];
+    if (hs->hull.size() >= 3) {
+      if (!remove_point(hs, p)) missing++;
+      continue;
+    }
+    size_t f = 0;
+    while (f < hs->flat.size() && (hs->flat[f].x != p.x || hs->flat[f].y != p.y)) f++;
+    if (f == hs->flat.size()) {
+      missing++;
+      continue;
+    }
+    hs->flat[f] = hs->flat.back();
+    hs->flat.pop_back();
+    dirty = 1;
+  }
+
+  for (size_t k = 0; k < added.size(); k++) {
+    if (hs->hull.size() >= 3) {
+      add_point(hs, added[k]);
+      continue;
+    }
+    hs->flat.push_back(added[k]);
+    dirty = 1;
+  }
+
+  if (dirty) {
+    vector<point2d> all = hs->flat;
+    rebuild(hs, all);
+  }
+  return missing;
+}
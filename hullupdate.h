@@ -0,0 +1,70 @@
+#ifndef __hullupdate_h
+#define __hullupdate_h
+
+#include "geom.h"
+#include "slidinghull.h"
+
+#include <vector>
+#include <set>
+
+using namespace std;
+
+
+/*
+  hull of a point set that changes by a few points at a time.
+
+  besides the hull, the state keeps every other point in a bucket: the
+  bucket of edge i holds the points in the wedge between the rays from
+  an anchor point c (strictly inside the hull) through hull[i] and
+  hull[i+1]. a point is found in its bucket by binary search on the
+  angle around c, so adding or removing a point that does not change
+  the hull costs O(log h + log n).
+
+  a point added outside the hull replaces the chain of vertices it
+  sees; only the buckets of the replaced edges are redistributed.
+  removing a hull vertex rebuilds the chain between its two neighbours
+  from the buckets of its two edges, which contain all the candidates.
+  the whole hull is recomputed only if the hull degenerates (fewer than
+  3 vertices) or shrinks so much that c is no longer strictly inside.
+  changes to the hull also cost O(h) to shift the vertices.
+*/
+
+typedef multiset<point2d, point2d_xless> point_bucket;
+
+typedef struct _hull_state {
+  //CCW, hull[0] the bottom point (rightmost if tied), like build_hull()
+  vector<point2d> hull;
+  //bucket[i]: the non-hull points in the wedge of edge hull[i] -> hull[i+1]
+  vector<point_bucket> bucket;
+  //the anchor c, times 3 (it is the centroid of 3 hull vertices)
+  long long cx3, cy3;
+  //all the points, if the hull has fewer than 3 vertices
+  vector<point2d> flat;
+  long n;
+
+  //what the updates cost
+  long nlocal;      //points added or removed without a rebuild
+  long npartial;    //chain rebuilds after removing a hull vertex
+  long nfull;       //whole hull recomputed
+} hull_state;
+
+
+/* initializes the state with the points pts */
+void hull_state_init(hull_state* hs, const vector<point2d>& pts);
+
+/*
+  removes the points in removed, then adds the points in added (so a
+  moved point is removed from its old position and added at the new
+  one). a point that is removed but not in the set is ignored.
+  returns the number of such points
+*/
+int update_hull(hull_state* hs, const vector<point2d>& added, const vector<point2d>& removed);
+
+/* number of points in the set */
+long hull_state_size(const hull_state* hs);
+
+/* stores all the points of the set in pts, in no particular order */
+void hull_state_points(const hull_state* hs, vector<point2d>& pts);
+
+
+#endif
@@ -0,0 +1,498 @@
+#include "kinetichull.h"
+#include <assert.h>
+#include <stdio.h>
+#include <math.h>
+
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+
+//the certificates of a hull vertex
+#define CERT_CONVEX  0   //prev, u, next make a left turn
+#define CERT_ANCHOR  1   //c is left of the edge u -> next
+//the certificates of a point p in the triangle c, a, b
+#define CERT_EDGE    2   //p is left of a -> b
+#define CERT_RAY_A   3   //p is left of the ray c -> a
+#define CERT_RAY_B   4   //p is right of the ray c -> b
+
+//coefficients below this, relative to the size of the terms, are taken
+//to be 0: they are within the rounding error of the positions
+static const double REL_EPS = 1e-12;
+
+
+/* ****************************** */
+/* a point now and its velocity */
+typedef struct _motion {
+  double x, y, vx, vy;
+} motion;
+
+static inline motion at_now(const kinetic_hull* k, int i) {
+  const kinetic_point& p = k->pts[i];
+  double dt = k->now - p.t;
+  motion m = {p.x + p.vx * dt, p.y + p.vy * dt, p.vx, p.vy};
+  return m;
+}
+
+static inline motion anchor(const kinetic_hull* k) {
+  motion m = {k->c.x, k->c.y, 0, 0};
+  return m;
+}
+
+static inline int same_fpoint(fpoint2d a, fpoint2d b) {
+  return a.x == b.x && a.y == b.y;
+}
+
+static inline fpoint2d position(const motion& m) {
+  fpoint2d p = {m.x, m.y};
+  return p;
+}
+
+/*
+  the orientation of a, b, p as a function of the time tau from now:
+  a tau^2 + b tau + c, in q[0..3) = {a, b, c}, and in e[0..3) how close
+  to 0 each coefficient has to be to count as 0
+*/
+static void orient_poly(const motion& a, const motion& b, const motion& p, double* q, double* e) {
+  double d1x = b.x - a.x, d1y = b.y - a.y, d2x = p.x - a.x, d2y = p.y - a.y;
+  double e1x = b.vx - a.vx, e1y = b.vy - a.vy, e2x = p.vx - a.vx, e2y = p.vy - a.vy;
+  q[2] = d1x * d2y - d1y * d2x;
+  q[1] = d1x * e2y - d1y * e2x + e1x * d2y - e1y * d2x;
+  q[0] = e1x * e2y - e1y * e2x;
+
+  double ld = fabs(d1x) + fabs(d1y) + fabs(d2x) + fabs(d2y);
+  double le = fabs(e1x) + fabs(e1y) + fabs(e2x) + fabs(e2y);
+  double mag = max(max(fabs(a.x), fabs(a.y)), max(max(fabs(b.x), fabs(b.y)), max(fabs(p.x), fabs(p.y))));
+  e[2] = REL_EPS * ld * (ld + mag);
+  e[1] = REL_EPS * le * (ld + mag);
+  e[0] = REL_EPS * le * le;
+}
+
+/*
+  the first time tau >= 0 at which a tau^2 + b tau + c becomes negative
+  (or 0, if strict); HUGE_VAL if never. its sign just after now is that
+  of the first of c, b, a that is not 0, so a certificate that has just
+  become 0 fails now only if it is about to become negative
+*/
+static double failure_time(const double* q, const double* e, int strict) {
+  double a = fabs(q[0]) <= e[0] ? 0 : q[0];
+  double b = fabs(q[1]) <= e[1] ? 0 : q[1];
+  double c = fabs(q[2]) <= e[2] ? 0 : q[2];
+
+  double s = c != 0 ? c : b != 0 ? b : a;
+  if (s < 0 || (s == 0 && strict)) return 0;
+  //0 forever
+  if (s == 0) return HUGE_VAL;
+
+  if (a == 0) return b < 0 ? -c / b : HUGE_VAL;
+  double disc = b * b - 4 * a * c;
+  //no roots: the sign of a throughout. one double root: touches 0
+  if (disc < 0) return a > 0 ? HUGE_VAL : 0;
+  if (disc == 0) return HUGE_VAL;
+  double r = sqrt(disc);
+  double qq = -0.5 * (b + (b < 0 ? -r : r));
+  double r1 = qq / a, r2 = c / qq;
+  if (r1 > r2) swap(r1, r2);
+  //a > 0: negative between the roots; a < 0: after the larger one
+  if (a > 0) return r1 > 0 ? r1 : HUGE_VAL;
+  return r2 > 0 ? r2 : 0;
+}
+
+
+/* ****************************** */
+struct event_later {
+  bool operator()(const kinetic_event& a, const kinetic_event& b) const { return a.t > b.t; }
+};
+
+static void push_event(kinetic_hull* k, int i) {
+  kinetic_event e = {k->fail_t[i], i, k->fail_kind[i], k->version[i]};
+  k->queue.push_back(e);
+  push_heap(k->queue.begin(), k->queue.end(), event_later());
+}
+
+/* computes the certificate of point i, and queues its failure */
+static void certify(kinetic_hull* k, int i) {
+  double q[3], e[3];
+  double tau;
+  int kind;
+  motion c = anchor(k);
+  motion p = at_now(k, i);
+  if (k->next[i] >= 0) {
+    motion u = at_now(k, k->prev[i]), w = at_now(k, k->next[i]);
+    orient_poly(u, p, w, q, e);
+    tau = failure_time(q, e, 1);
+    kind = CERT_CONVEX;
+    orient_poly(p, w, c, q, e);
+    double t2 = failure_time(q, e, 1);
+    if (t2 < tau) {
+      tau = t2;
+      kind = CERT_ANCHOR;
+    }
+  } else {
+    motion a = at_now(k, k->tri[2*i]), b = at_now(k, k->tri[2*i+1]);
+    orient_poly(a, b, p, q, e);
+    tau = failure_time(q, e, 0);
+    kind = CERT_EDGE;
+    orient_poly(c, a, p, q, e);
+    double t2 = failure_time(q, e, 0);
+    if (t2 < tau) {
+      tau = t2;
+      kind = CERT_RAY_A;
+    }
+    orient_poly(b, c, p, q, e);
+    t2 = failure_time(q, e, 0);
+    if (t2 < tau) {
+      tau = t2;
+      kind = CERT_RAY_B;
+    }
+  }
+  k->stats.certs++;
+  k->fail_t[i] = k->now + tau;
+  k->fail_kind[i] = kind;
+  k->version[i]++;
+  if (tau < HUGE_VAL) push_event(k, i);
+}
+
+/* 1 if the orientation of a, b, p is about to become negative */
+static int failing_now(const motion& a, const motion& b, const motion& p) {
+  double q[3], e[3];
+  orient_poly(a, b, p, q, e);
+  return failure_time(q, e, 0) == 0;
+}
+
+
+/* ****************************** */
+static void add_ref(kinetic_hull* k, int x, int entry) {
+  k->tri[entry] = x;
+  k->ref_slot[entry] = k->refs[x].size();
+  k->refs[x].push_back(entry);
+}
+
+static void remove_ref(kinetic_hull* k, int entry) {
+  vector<int>& r = k->refs[k->tri[entry]];
+  int last = r.back();
+  r[k->ref_slot[entry]] = last;
+  k->ref_slot[last] = k->ref_slot[entry];
+  r.pop_back();
+  k->tri[entry] = -1;
+}
+
+/* puts p in the triangle c, a, b */
+static void assign(kinetic_hull* k, int p, int a, int b) {
+  add_ref(k, a, 2*p);
+  add_ref(k, b, 2*p+1);
+}
+
+static void unassign(kinetic_hull* k, int p) {
+  remove_ref(k, 2*p);
+  remove_ref(k, 2*p+1);
+}
+
+/* puts p, which is not on the hull, in the triangle of the hull edge
+   at its angle around c */
+static void locate(kinetic_hull* k, int p) {
+  const vector<int>& ring = k->ring;
+  int m = ring.size();
+  fpoint2d c = k->c;
+  motion mp = at_now(k, p);
+  //angles from the ray c -> ring[0], which increase along the ring
+  fpoint2d r0 = position(at_now(k, ring[0]));
+  double a0 = atan2(r0.y - c.y, r0.x - c.x);
+  double ap = atan2(mp.y - c.y, mp.x - c.x) - a0;
+  if (ap < 0) ap += 2 * M_PI;
+  int lo = 0, hi = m;
+  while (hi - lo > 1) {
+    int mid = (lo + hi) / 2;
+    fpoint2d r = position(at_now(k, ring[mid]));
+    double a = atan2(r.y - c.y, r.x - c.x) - a0;
+    if (a < 0) a += 2 * M_PI;
+    if (a <= ap) lo = mid;
+    else hi = mid;
+  }
+
+  //near a ray the angles may be off by rounding: step to the triangle
+  //that p is in, or is moving into, by the signs of the certificates
+  int u = ring[lo];
+  motion mc = anchor(k);
+  for (int steps = 0; steps < m; steps++) {
+    if (failing_now(mc, at_now(k, u), mp)) {
+      u = k->prev[u];
+    } else if (failing_now(at_now(k, k->next[u]), mc, mp)) {
+      u = k->next[u];
+    } else {
+      break;
+    }
+  }
+  assign(k, p, u, k->next[u]);
+}
+
+/* the hull of the points now, CCW (Andrew's monotone chain, with
+   the exact orient2d() of geomf.h) */
+static void hull_ids(const kinetic_hull* k, vector<int>& ids) {
+  int n = k->pts.size();
+  vector<fpoint2d> pos(n);
+  for (int i = 0; i < n; i++) pos[i] = position(at_now(k, i));
+  vector<int> order(n);
+  for (int i = 0; i < n; i++) order[i] = i;
+  sort(order.begin(), order.end(), [&](int a, int b) {
+    return pos[a].x < pos[b].x || (pos[a].x == pos[b].x && pos[a].y < pos[b].y);
+  });
+
+  ids.assign(2 * n + 1, 0);
+  int m = 0;
+  for (int j = 0; j < n; j++) {
+    while (m >= 2 && orient2d(pos[ids[m-2]], pos[ids[m-1]], pos[order[j]]) <= 0) m--;
+    ids[m++] = order[j];
+  }
+  for (int j = n - 2, lower = m + 1; j >= 0; j--) {
+    while (m >= lower && orient2d(pos[ids[m-2]], pos[ids[m-1]], pos[order[j]]) <= 0) m--;
+    ids[m++] = order[j];
+  }
+  //the first point is repeated at the end
+  ids.resize(n > 1 ? m - 1 : n);
+}
+
+/* recomputes the hull, the triangles and all the certificates now */
+static void rebuild(kinetic_hull* k) {
+  int n = k->pts.size();
+  k->stats.rebuilds++;
+  k->next.assign(n, -1);
+  k->prev.assign(n, -1);
+  k->tri.assign(2 * n, -1);
+  k->ref_slot.assign(2 * n, 0);
+  k->refs.assign(n, vector<int>());
+  k->fail_t.assign(n, HUGE_VAL);
+  k->fail_kind.assign(n, 0);
+  k->version.resize(n);
+  k->queue.clear();
+
+  vector<int> ids;
+  hull_ids(k, ids);
+  int m = ids.size();
+  k->ring.clear();
+  if (m < 3) {
+    //no triangles: kinetic_hull_advance() rebuilds until there are some
+    return;
+  }
+  k->ring = ids;
+  for (int j = 0; j < m; j++) {
+    k->next[ids[j]] = ids[(j + 1) % m];
+    k->prev[ids[j]] = ids[(j + m - 1) % m];
+  }
+  //the centroid of 3 vertices of a strictly convex hull is strictly inside
+  fpoint2d a = position(at_now(k, ids[0])), b = position(at_now(k, ids[m/3])),
+    c = position(at_now(k, ids[2*m/3]));
+  k->c.x = (a.x + b.x + c.x) / 3;
+  k->c.y = (a.y + b.y + c.y) / 3;
+
+  for (int i = 0; i < n; i++) {
+    if (k->next[i] < 0) locate(k, i);
+  }
+  for (int i = 0; i < n; i++) certify(k, i);
+}
+
+
+/* ****************************** */
+static int ring_index(const kinetic_hull* k, int v) {
+  return find(k->ring.begin(), k->ring.end(), v) - k->ring.begin();
+}
+
+/* vertex v is no longer convex: it goes in the triangle of the edge
+   that replaces it */
+static void remove_vertex(kinetic_hull* k, int v) {
+  if (k->ring.size() <= 3) {
+    rebuild(k);
+    return;
+  }
+  int a = k->prev[v], b = k->next[v];
+  k->next[a] = b;
+  k->prev[b] = a;
+  k->next[v] = k->prev[v] = -1;
+  k->ring.erase(k->ring.begin() + ring_index(k, v));
+  k->stats.deletes++;
+
+  assign(k, v, a, b);
+  certify(k, v);
+  certify(k, a);
+  certify(k, b);
+}
+
+/* p crossed the hull edge a -> b: it becomes a vertex between them */
+static void insert_vertex(kinetic_hull* k, int p, int a, int b) {
+  unassign(k, p);
+  k->next[a] = p;
+  k->prev[p] = a;
+  k->next[p] = b;
+  k->prev[b] = p;
+  k->ring.insert(k->ring.begin() + ring_index(k, a) + 1, p);
+  k->stats.inserts++;
+
+  //the triangles of the other points are still inside the hull
+  certify(k, a);
+  certify(k, p);
+  certify(k, b);
+}
+
+/* p left its triangle, but not through a hull edge */
+static void move_point(kinetic_hull* k, int p) {
+  unassign(k, p);
+  locate(k, p);
+  k->stats.moves++;
+  certify(k, p);
+}
+
+static void handle(kinetic_hull* k, int i, int kind) {
+  switch (kind) {
+  case CERT_CONVEX:
+    remove_vertex(k, i);
+    break;
+  case CERT_ANCHOR:
+    //c is about to be outside: start over with a new one
+    rebuild(k);
+    break;
+  case CERT_EDGE: {
+    int a = k->tri[2*i], b = k->tri[2*i+1];
+    if (k->next[a] == b) insert_vertex(k, i, a, b);
+    else move_point(k, i);
+    break;
+  }
+  case CERT_RAY_A:
+  case CERT_RAY_B:
+    move_point(k, i);
+    break;
+  }
+}
+
+
+/* ****************************** */
+void kinetic_hull_init(kinetic_hull* k, const vector<fpoint2d>& pos,
+                       const vector<fpoint2d>& vel, double t) {
+  assert(pos.size() == vel.size());
+  int n = pos.size();
+  k->pts.resize(n);
+  for (int i = 0; i < n; i++) {
+    kinetic_point p = {pos[i].x, pos[i].y, vel[i].x, vel[i].y, t};
+    k->pts[i] = p;
+  }
+  k->now = t;
+  k->version.assign(n, 0);
+  k->stats = kinetic_stats();
+  rebuild(k);
+}
+
+void kinetic_hull_advance(kinetic_hull* k, double t) {
+  assert(t >= k->now);
+  if (k->ring.empty()) {
+    k->now = t;
+    rebuild(k);
+    return;
+  }
+
+  //rounding could in theory make two certificates undo each other
+  //forever; after this many failures in one step, start over instead
+  long budget = 10 * (long)k->pts.size() + 1000;
+  while (!k->queue.empty() && k->queue.front().t <= t) {
+    kinetic_event e = k->queue.front();
+    pop_heap(k->queue.begin(), k->queue.end(), event_later());
+    k->queue.pop_back();
+    if (e.version != k->version[e.id]) continue;
+    if (--budget < 0) break;
+    k->now = max(k->now, e.t);
+    k->stats.events++;
+    handle(k, e.id, e.kind);
+    if (k->ring.empty()) break;
+  }
+  k->now = t;
+  if (budget < 0 || k->ring.empty()) {
+    rebuild(k);
+    return;
+  }
+
+  //the queue keeps the events that went stale: drop them once they
+  //outnumber the live ones
+  int n = k->pts.size();
+  if (k->queue.size() > 2 * (size_t)n + 64) {
+    k->queue.clear();
+    for (int i = 0; i < n; i++) {
+      if (k->fail_t[i] < HUGE_VAL) {
+        kinetic_event e = {k->fail_t[i], i, k->fail_kind[i], k->version[i]};
+        k->queue.push_back(e);
+      }
+    }
+    make_heap(k->queue.begin(), k->queue.end(), event_later());
+  }
+}
+
+void kinetic_hull_set_velocity(kinetic_hull* k, int i, fpoint2d v) {
+  motion m = at_now(k, i);
+  kinetic_point p = {m.x, m.y, v.x, v.y, k->now};
+  k->pts[i] = p;
+  if (k->ring.empty()) return;
+
+  //i is in its own certificate, in those of its neighbours if it is a
+  //vertex, and in those of the points whose triangles have it as a corner
+  certify(k, i);
+  if (k->next[i] >= 0) {
+    certify(k, k->prev[i]);
+    certify(k, k->next[i]);
+  }
+  const vector<int>& r = k->refs[i];
+  for (size_t j = 0; j < r.size(); j++) certify(k, r[j] / 2);
+}
+
+fpoint2d kinetic_hull_position(const kinetic_hull* k, int i) {
+  return position(at_now(k, i));
+}
+
+void kinetic_hull_get(const kinetic_hull* k, vector<fpoint2d>& hull) {
+  hull.clear();
+  if (k->ring.empty()) {
+    //degenerate: the hull is recomputed on every step anyway
+    vector<int> ids;
+    hull_ids(k, ids);
+    for (size_t j = 0; j < ids.size(); j++) hull.push_back(kinetic_hull_position(k, ids[j]));
+  } else {
+    for (size_t j = 0; j < k->ring.size(); j++) hull.push_back(kinetic_hull_position(k, k->ring[j]));
+  }
+
+  //start at the bottom point
+  int b = 0;
+  for (size_t j = 1; j < hull.size(); j++) {
+    if (hull[j].y < hull[b].y || (hull[j].y == hull[b].y && hull[j].x > hull[b].x)) b = j;
+  }
+  rotate(hull.begin(), hull.begin() + b, hull.end());
+  int m = hull.size();
+  if (m < 3) return;
+
+  //the certificates allow a vertex to make a zero turn (collinear or
+  //coincident points, while they stay so), and the positions are
+  //rounded, so the ring may have vertices that graham_scan() would not
+  //keep. it is sorted by angle around c, which is inside it, so one
+  //Graham pass from the bottom point drops them; its copies are
+  //skipped. if all the vertices are on a line through the bottom
+  //point, the hull is the segment to the farthest one
+  int far = 0, flat = 1;
+  for (int j = 1; j < m; j++) {
+    if (same_fpoint(hull[j], hull[0])) continue;
+    if (far && !collinear(hull[0], hull[far], hull[j])) {
+      flat = 0;
+      break;
+    }
+    if (!far || fabs(hull[j].x - hull[0].x) + fabs(hull[j].y - hull[0].y) >
+        fabs(hull[far].x - hull[0].x) + fabs(hull[far].y - hull[0].y)) far = j;
+  }
+  if (flat) {
+    hull[1] = hull[far];
+    hull.resize(far ? 2 : 1);
+    return;
+  }
+  int top = 1;
+  for (int j = 1; j < m; j++) {
+    if (same_fpoint(hull[j], hull[0])) continue;
+    while (top >= 2 && !left_strictly(hull[top-2], hull[top-1], hull[j])) top--;
+    hull[top++] = hull[j];
+  }
+  while (top >= 3 && !left_strictly(hull[top-2], hull[top-1], hull[0])) top--;
+  hull.resize(top);
+}
@@ -0,0 +1,107 @@
+#ifndef __kinetichull_h
+#define __kinetichull_h
+
+#include "geomf.h"
+
+#include <vector>
+
+using namespace std;
+
+
+/*
+  kinetic hull: the hull of points that move with constant velocities,
+  kept up to date as time advances instead of being recomputed.
+
+  the hull is proven by certificates, each an orientation that must
+  stay positive. with linear motion an orientation is a quadratic in
+  t, so the time at which a certificate fails is a root, and the
+  failures are kept in a priority queue. advancing to time t processes
+  the failures up to t in order, each repaired locally:
+
+  - a hull vertex u: its neighbours make a left turn at u (else u is
+    removed from the hull), and the anchor c is left of its edge.
+  - any other point p is in a triangle c, a, b, where a -> b was a
+    hull edge when p was put in it: p is left of a -> b and between
+    the rays from c through a and b.
+
+  a and b need not stay hull vertices: c is inside the hull, and the
+  hull is convex, so the triangle stays inside the hull as long as a
+  and b are points. so an insertion or a deletion recomputes O(1)
+  certificates (and costs O(h) to keep the vertices in an array by
+  angle). a point that leaves its triangle through a hull edge becomes
+  a vertex; otherwise it is put in the triangle of the hull edge at its
+  angle around c, found by binary search. c is fixed; the hull is
+  rebuilt around a new c only if an edge passes over c, or if the hull
+  degenerates (fewer than 3 vertices).
+
+  the points may change velocity at any time (kinetic_hull_set_velocity),
+  which recomputes only the certificates they are in.
+*/
+
+typedef struct _kinetic_point {
+  double x, y;    //position at time t
+  double vx, vy;  //velocity
+  double t;
+} kinetic_point;
+
+typedef struct _kinetic_event {
+  double t;          //when the certificate of point id fails
+  int id;
+  int kind;
+  unsigned version;  //stale if the point got a new certificate since
+} kinetic_event;
+
+typedef struct _kinetic_stats {
+  long events;      //certificate failures processed
+  long inserts;     //points that became hull vertices
+  long deletes;     //hull vertices that became interior
+  long moves;       //points that left their triangle for another one
+  long certs;       //certificates computed
+  long rebuilds;    //hull recomputed from scratch
+} kinetic_stats;
+
+typedef struct _kinetic_hull {
+  vector<kinetic_point> pts;
+  double now;
+  //strictly inside the hull
+  fpoint2d c;
+  //the hull, a circular list of point ids, CCW; -1 for points not on it
+  vector<int> next, prev;
+  //the vertices in CCW order, i.e. sorted by angle around c; empty if
+  //the hull has fewer than 3
+  vector<int> ring;
+  //for a point p not on the hull, its triangle c, tri[2p], tri[2p+1];
+  //refs[x] lists the entries of tri that are x, at ref_slot[entry]
+  vector<int> tri, ref_slot;
+  vector<vector<int> > refs;
+  //the certificate of every point: when it fails and how
+  vector<double> fail_t;
+  vector<int> fail_kind;
+  vector<unsigned> version;
+  vector<kinetic_event> queue;   //a min-heap on t
+  kinetic_stats stats;
+} kinetic_hull;
+
+
+/* starts the points at positions pos with velocities vel, at time t */
+void kinetic_hull_init(kinetic_hull* k, const vector<fpoint2d>& pos,
+                       const vector<fpoint2d>& vel, double t);
+
+/* moves time forward to t (not before k->now), repairing the hull at
+   every certificate failure on the way */
+void kinetic_hull_advance(kinetic_hull* k, double t);
+
+/* point i moves with velocity v from now on */
+void kinetic_hull_set_velocity(kinetic_hull* k, int i, fpoint2d v);
+
+/* where point i is now */
+fpoint2d kinetic_hull_position(const kinetic_hull* k, int i);
+
+/* the hull now, CCW starting at the bottom point (rightmost if tied),
+   with no collinear vertices, like graham_scan(). points that are
+   collinear with a hull edge but for the rounding of their positions
+   count as on it, where graham_scan() of the positions may keep them */
+void kinetic_hull_get(const kinetic_hull* k, vector<fpoint2d>& hull);
+
+
+#endif
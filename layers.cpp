@@ -0,0 +1,133 @@
+#include "layers.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+
+/* orders indices of points by x, then by y */
+struct xy_index_less {
+  const point2d* pts;
+  bool operator()(int i, int j) const {
+    return pts[i].x < pts[j].x || (pts[i].x == pts[j].x && pts[i].y < pts[j].y);
+  }
+};
+
+
+/* **************************************** */
+/* left_strictly(), inlined: the passes below are nothing but this */
+static inline int turns_left(point2d a, point2d b, point2d c) {
+  return ((long long)b.x - a.x) * ((long long)c.y - a.y)
+    - ((long long)b.y - a.y) * ((long long)c.x - a.x) > 0;
+}
+
+/*
+  one monotone chain pass over p[0..m), left to right for the lower
+  hull (dir = 1) or right to left for the upper hull (dir = -1). the
+  stack holds positions in p. turns that are not strictly left are
+  popped, so copies of a point and collinear points never stay on the
+  chain, and both chains start and end at the same two positions
+*/
+static void chain(const point2d* p, int m, int dir, vector<int>& stack) {
+  stack.clear();
+  for (int j = 0; j < m; j++) {
+    int i = dir > 0 ? j : m - 1 - j;
+    while (stack.size() >= 2 && !turns_left(p[stack[stack.size()-2]], p[stack.back()], p[i])) {
+      stack.pop_back();
+    }
+    stack.push_back(i);
+  }
+}
+
+/*
+  peels the first k layers (all if k <= 0). layers[l] gets the indices
+  into pts of the vertices of layer l, in CCW order starting at the
+  bottom point
+*/
+static int peel(const vector<point2d>& pts, int k, vector<vector<int> >& layers) {
+  int n = pts.size();
+  layers.clear();
+  if (n == 0) return 0;
+
+  //the points left, sorted, and their indices in pts. peeling a layer
+  //compacts both in place, which keeps the order
+  vector<int> ord(n);
+  for (int i = 0; i < n; i++) ord[i] = i;
+  xy_index_less less;
+  less.pts = pts.data();
+  sort(ord.begin(), ord.end(), less);
+  vector<point2d> left(n);
+  for (int i = 0; i < n; i++) left[i] = pts[ord[i]];
+  point2d* p = left.data();
+  int m = n;
+
+  vector<int> lower, upper, layer;
+  vector<char> peeled(n, 0);
+  while (m > 0 && (k <= 0 || (int)layers.size() < k)) {
+    chain(p, m, 1, lower);
+    chain(p, m, -1, upper);
+
+    layer.clear();
+    if (p[0].x == p[m-1].x && p[0].y == p[m-1].y) {
+      //all the points left are copies of one point
+      layer.push_back(0);
+    } else {
+      layer.insert(layer.end(), lower.begin(), lower.end() - 1);
+      layer.insert(layer.end(), upper.begin(), upper.end() - 1);
+    }
+
+    //bottom point first, rightmost if tied
+    int b = 0;
+    for (int j = 1; j < (int)layer.size(); j++) {
+      point2d q = p[layer[j]], r = p[layer[b]];
+      if (q.y < r.y || (q.y == r.y && q.x > r.x)) b = j;
+    }
+    rotate(layer.begin(), layer.begin() + b, layer.end());
+    layers.push_back(vector<int>(layer.size()));
+    for (size_t j = 0; j < layer.size(); j++) {
+      layers.back()[j] = ord[layer[j]];
+      peeled[layer[j]] = 1;
+    }
+
+    //remove the layer
+    int w = 0;
+    for (int i = 0; i < m; i++) {
+      if (peeled[i]) {
+        peeled[i] = 0;
+        continue;
+      }
+      p[w] = p[i];
+      ord[w] = ord[i];
+      w++;
+    }
+    m = w;
+  }
+  return layers.size();
+}
+
+
+/* **************************************** */
+int convex_layers(const vector<point2d>& pts, vector<vector<point2d> >& layers, int k) {
+  vector<vector<int> > idx;
+  int nlayers = peel(pts, k, idx);
+  layers.resize(nlayers);
+  for (int l = 0; l < nlayers; l++) {
+    layers[l].resize(idx[l].size());
+    for (size_t j = 0; j < idx[l].size(); j++) layers[l][j] = pts[idx[l][j]];
+  }
+  return nlayers;
+}
+
+int convex_layers(const vector<point2d>& pts, vector<int>& layer_of, int k) {
+  vector<vector<int> > idx;
+  int nlayers = peel(pts, k, idx);
+  layer_of.assign(pts.size(), -1);
+  for (int l = 0; l < nlayers; l++) {
+    for (size_t j = 0; j < idx[l].size(); j++) layer_of[idx[l][j]] = l;
+  }
+  return nlayers;
+}
@@ -0,0 +1,42 @@
+#ifndef __layers_h
+#define __layers_h
+
+#include "geom.h"
+
+#include <vector>
+
+using namespace std;
+
+
+/*
+  convex layers (onion peeling): layer 0 is the hull of the points,
+  layer 1 the hull of the points left after removing the vertices of
+  layer 0, and so on until no points are left.
+
+  the points are sorted once, by x then y. the points not yet peeled
+  stay in an array in that order, so every layer is computed by a
+  monotone chain pass over the remaining points with no sorting, and
+  peeling it is one compaction pass. the total cost is
+  O(n log n + sum of the sizes of the remaining sets), instead of a
+  sort per layer.
+
+  every layer is in CCW order starting at its bottom point (rightmost
+  if tied), without collinear vertices, like graham_scan(). points on
+  an edge of a layer but not vertices of it are left for the next
+  layers, and copies of a vertex are peeled one per layer.
+*/
+
+/*
+  computes the first k layers of pts (all of them if k <= 0) into
+  layers, and returns their number
+*/
+int convex_layers(const vector<point2d>& pts, vector<vector<point2d> >& layers, int k = 0);
+
+/*
+  the same, but stores for every point the index of its layer in
+  layer_of (or -1 if it is deeper than the first k layers)
+*/
+int convex_layers(const vector<point2d>& pts, vector<int>& layer_of, int k = 0);
+
+
+#endif
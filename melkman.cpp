@@ -0,0 +1,127 @@
+#include "melkman.h"
+#include "hullquery.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+
+/* **************************************** */
+static inline int same_point(point2d a, point2d b) {
+  return a.x == b.x && a.y == b.y;
+}
+
+/* x then y: along a line, this orders the points going one way */
+static inline int xy_less(point2d a, point2d b) {
+  return a.x < b.x || (a.x == b.x && a.y < b.y);
+}
+
+/* rotates hull so that it starts at its bottom point, rightmost if tied */
+static void bottom_first(vector<point2d>& hull) {
+  int b = 0;
+  for (int i = 1; i < (int)hull.size(); i++) {
+    if (hull[i].y < hull[b].y || (hull[i].y == hull[b].y && hull[i].x > hull[b].x)) b = i;
+  }
+  rotate(hull.begin(), hull.begin() + b, hull.end());
+}
+
+
+/* **************************************** */
+void melkman_hull_unchecked(const vector<point2d>& pts, vector<point2d>& hull) {
+  hull.clear();
+  int n = pts.size();
+  if (n == 0) return;
+
+  //while the points are collinear the hull is the segment between the
+  //two extremes so far
+  point2d lo = pts[0], hi = pts[0];
+  int i = 1;
+  for (; i < n; i++) {
+    point2d p = pts[i];
+    if (!same_point(lo, hi) && !collinear(lo, hi, p)) break;
+    if (xy_less(p, lo)) lo = p;
+    if (xy_less(hi, p)) hi = p;
+  }
+  if (i == n) {
+    hull.push_back(lo);
+    if (!same_point(lo, hi)) hull.push_back(hi);
+    bottom_first(hull);
+    return;
+  }
+
+  //the deque d[bot..top] is the hull of the points so far, CCW, with
+  //the last point at both ends. every point is pushed at most once at
+  //each end, so 2n slots around the middle are enough
+  vector<point2d> d(2 * n + 8);
+  int bot = n + 2, top = bot + 3;
+  point2d p = pts[i];
+  d[bot] = d[top] = p;
+  if (left_strictly(lo, hi, p)) {
+    d[bot+1] = lo;
+    d[bot+2] = hi;
+  } else {
+    d[bot+1] = hi;
+    d[bot+2] = lo;
+  }
+
+  for (i++; i < n; i++) {
+    p = pts[i];
+    //inside the hull, or in the part of it that the polyline cannot
+    //leave without crossing itself
+    if (left_on(d[bot], d[bot+1], p) && left_on(d[top-1], d[top], p)) continue;
+
+    //on a simple polyline the pops always stop before the deque is down
+    //to a segment; the guards only matter if it is not simple
+    while (top - bot > 1 && !left_strictly(d[top-1], d[top], p)) top--;
+    d[++top] = p;
+    while (top - bot > 1 && !left_strictly(p, d[bot], d[bot+1])) bot++;
+    d[--bot] = p;
+  }
+
+  hull.assign(d.begin() + bot, d.begin() + top);
+  bottom_first(hull);
+}
+
+
+/* **************************************** */
+int is_hull_polygon(const vector<point2d>& hull) {
+  int h = hull.size();
+  if (h == 0) return 0;
+  for (int i = 1; i < h; i++) {
+    //hull[0] is the bottom point
+    if (hull[i].y < hull[0].y || (hull[i].y == hull[0].y && hull[i].x >= hull[0].x)) return 0;
+  }
+  if (h <= 2) return 1;
+
+  //all turns strictly left, and the vertices sorted by angle around
+  //hull[0]; since they are all above hull[0], the angles span less than
+  //pi and the polygon cannot wind around more than once
+  for (int i = 0; i < h; i++) {
+    if (!left_strictly(hull[i], hull[(i+1) % h], hull[(i+2) % h])) return 0;
+  }
+  for (int i = 1; i + 1 < h; i++) {
+    if (!left_strictly(hull[0], hull[i], hull[i+1])) return 0;
+  }
+  return 1;
+}
+
+
+int melkman_hull(const vector<point2d>& pts, vector<point2d>& hull) {
+  melkman_hull_unchecked(pts, hull);
+
+  //a convex polygon with vertices from pts that contains all of pts is
+  //the hull of pts
+  int ok = is_hull_polygon(hull);
+  for (size_t i = 0; ok && i < pts.size(); i++) {
+    if (!hull_contains(hull, pts[i])) ok = 0;
+  }
+  if (ok) return 1;
+
+  hull = pts;
+  graham_scan_inplace(hull);
+  return 0;
+}
@@ -0,0 +1,43 @@
+#ifndef __melkman_h
+#define __melkman_h
+
+#include "geom.h"
+
+#include <vector>
+
+using namespace std;
+
+
+/*
+  hull of a simple polyline in O(n), with Melkman's algorithm: the
+  points are taken in order and the hull of the prefix is kept in a
+  deque with the last point at both ends, so every point is pushed and
+  popped at most once and nothing is sorted. the polyline may be open
+  or closed, and in either orientation.
+
+  Melkman's algorithm is only correct if the polyline does not cross
+  itself. since whether it does is not cheap to check, the result is
+  checked instead: it is the hull if it is strictly convex, winds
+  around once, and contains every input point, which costs
+  O(n log h). if the check fails (the polyline was not simple), the
+  hull is recomputed with graham_scan_inplace(), so a wrong flag costs
+  time but never gives a wrong hull.
+
+  the hull is in the same order as graham_scan(): CCW starting at the
+  bottom point (rightmost if tied), with no collinear vertices
+*/
+
+/* stores the hull of the polyline pts in hull. returns 1 if Melkman's
+   hull passed the check, 0 if it was recomputed */
+int melkman_hull(const vector<point2d>& pts, vector<point2d>& hull);
+
+/* Melkman's algorithm alone, without the check: the hull is only
+   right if pts is a simple polyline */
+void melkman_hull_unchecked(const vector<point2d>& pts, vector<point2d>& hull);
+
+/* return 1 if hull is strictly convex, CCW, winds around once and
+   starts at its bottom point (rightmost if tied) */
+int is_hull_polygon(const vector<point2d>& hull);
+
+
+#endif
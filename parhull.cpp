@@ -0,0 +1,60 @@
+#include "parhull.h"
+#include "hullgeneric.h"
+#include "hrtimer.h"
+#include <assert.h>
+#include <stdio.h>
+#include <pthread.h>
+
+#include <vector>
+
+using namespace std;
+
+
+typedef struct _slice_job {
+  const point2d* pts;
+  int n;
+  vector<int> idx;   //hull of the slice, as indices into it
+} slice_job;
+
+static void* slice_hull(void* arg) {
+  slice_job* job = (slice_job*)arg;
+  hull_indices(job->pts, job->n, &point2d::x, &point2d::y, job->idx);
+  return NULL;
+}
+
+
+void parallel_hull(const vector<point2d>& pts, vector<point2d>& hull, int nthreads) {
+  hull.clear();
+  int n = pts.size();
+  if (n == 0) return;
+  HRT_SCOPE("parallel_hull");
+  if (nthreads < 1) nthreads = 1;
+  if (nthreads > n) nthreads = n;
+
+  vector<slice_job> jobs(nthreads);
+  vector<pthread_t> threads(nthreads);
+  vector<char> started(nthreads, 0);
+  {
+    HRT_SCOPE("slices");
+    for (int t = 0; t < nthreads; t++) {
+      long lo = (long)n * t / nthreads, hi = (long)n * (t + 1) / nthreads;
+      jobs[t].pts = pts.data() + lo;
+      jobs[t].n = hi - lo;
+    }
+    //the first slice is done by this thread
+    for (int t = 1; t < nthreads; t++) {
+      started[t] = pthread_create(&threads[t], NULL, slice_hull, &jobs[t]) == 0;
+      if (!started[t]) slice_hull(&jobs[t]);
+    }
+    slice_hull(&jobs[0]);
+    for (int t = 1; t < nthreads; t++) {
+      if (started[t]) pthread_join(threads[t], NULL);
+    }
+  }
+
+  HRT_SCOPE("merge");
+  for (int t = 0; t < nthreads; t++) {
+    for (size_t i = 0; i < jobs[t].idx.size(); i++) hull.push_back(jobs[t].pts[jobs[t].idx[i]]);
+  }
+  if (nthreads > 1) graham_scan_inplace(hull);
+}
@@ -0,0 +1,26 @@
+#ifndef __parhull_h
+#define __parhull_h
+
+#include "geom.h"
+
+#include <vector>
+
+using namespace std;
+
+
+/*
+  hull with several threads, like hullshard but inside one process: the
+  points are cut into nthreads contiguous slices, every thread finds
+  the hull of its slice with hull_indices() (which reads the slice in
+  place and allocates only for the filter survivors), and the hull of
+  the slice hulls is the hull of all the points. the last step is
+  graham_scan_inplace() on at most nthreads * h points, so it is cheap
+  unless h is close to n.
+
+  only the scopes of the calling thread are timed (see hrt_enable()),
+  not those of the slices. the hull is in the same order as graham_scan()
+*/
+void parallel_hull(const vector<point2d>& pts, vector<point2d>& hull, int nthreads);
+
+
+#endif
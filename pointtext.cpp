@@ -0,0 +1,347 @@
+#include "pointtext.h"
+#include "hullquery.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <vector>
+#include <charconv>
+
+using namespace std;
+
+
+/* ****************************** */
+typedef struct _text_map {
+  const char* data;
+  size_t len;
+} text_map;
+
+static double now_seconds() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/* maps the file read-only; returns 0 if it cannot be read */
+static int map_text(const char* path, text_map* m) {
+  m->data = NULL;
+  m->len = 0;
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    perror(path);
+    return 0;
+  }
+  struct stat st;
+  if (fstat(fd, &st) < 0) {
+    perror(path);
+    close(fd);
+    return 0;
+  }
+  m->len = st.st_size;
+  if (m->len > 0) {
+    void* p = mmap(NULL, m->len, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+      perror(path);
+      close(fd);
+      return 0;
+    }
+    //read once, front to back
+    madvise(p, m->len, MADV_SEQUENTIAL);
+    m->data = (const char*)p;
+  }
+  //the mapping keeps the file
+  close(fd);
+  return 1;
+}
+
+static void unmap_text(text_map* m) {
+  if (m->data) munmap((void*)m->data, m->len);
+  m->data = NULL;
+}
+
+/* cuts [0, len) into nslices parts, each starting at the start of a
+   line: cut[t] is the start of slice t, cut[nslices] = len */
+static void slice_bounds(const char* d, size_t len, int nslices, vector<size_t>& cut) {
+  cut.assign(nslices + 1, len);
+  cut[0] = 0;
+  for (int t = 1; t < nslices; t++) {
+    size_t c = max(cut[t-1], len / nslices * t);
+    //the start of the first line at or after c
+    if (c > 0 && c < len && d[c-1] != '\n') {
+      const char* nl = (const char*)memchr(d + c, '\n', len - c);
+      c = nl ? nl - d + 1 : len;
+    }
+    cut[t] = c;
+  }
+}
+
+
+/* ****************************** */
+static inline int is_blank(char c) {
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+static inline int is_sep(char c) {
+  return c == ' ' || c == '\t' || c == ',' || c == ';';
+}
+
+/*
+  parses the line starting at p (end is the end of the slice). returns
+  1 and the point in *q if it is a point, 0 if it is blank or a
+  comment, -1 if it is bad. *next is set to the start of the next line
+*/
+static inline int parse_line(const char* p, const char* end, point2d* q, const char** next) {
+  while (p < end && is_blank(*p)) p++;
+  if (p == end || *p == '\n') {
+    *next = p < end ? p + 1 : end;
+    return 0;
+  }
+
+  int ret = -1;
+  if (*p != '#') {
+    from_chars_result r = from_chars(p, end, q->x);
+    if (r.ec == errc()) {
+      p = r.ptr;
+      while (p < end && is_sep(*p)) p++;
+      r = from_chars(p, end, q->y);
+      if (r.ec == errc()) {
+        p = r.ptr;
+        ret = 1;
+      }
+    }
+  } else {
+    ret = 0;
+  }
+
+  //skip the rest of the line
+  const char* nl = (const char*)memchr(p, '\n', end - p);
+  *next = nl ? nl + 1 : end;
+  return ret;
+}
+
+
+/* ****************************** */
+/* the work of one thread: its slice of the file, and what it found */
+typedef struct _text_job {
+  const char* begin;
+  const char* end;
+  long lines;            //upper bound on the points in the slice
+  point2d* out;          //where read_points_text() puts the points
+  long points, bad;
+  vector<point2d> hull;  //for hull_of_text_file()
+  int chunk;
+} text_job;
+
+typedef void* (*job_fn)(void*);
+
+/* runs fn on every job, job 0 in this thread */
+static void run_jobs(job_fn fn, vector<text_job>& jobs) {
+  int n = jobs.size();
+  vector<pthread_t> threads(n);
+  vector<char> started(n, 0);
+  for (int t = 1; t < n; t++) {
+    started[t] = pthread_create(&threads[t], NULL, fn, &jobs[t]) == 0;
+    if (!started[t]) fn(&jobs[t]);
+  }
+  fn(&jobs[0]);
+  for (int t = 1; t < n; t++) {
+    if (started[t]) pthread_join(threads[t], NULL);
+  }
+}
+
+static void* count_lines(void* arg) {
+  text_job* job = (text_job*)arg;
+  long lines = 0;
+  const char* p = job->begin;
+  while (p < job->end) {
+    const char* nl = (const char*)memchr(p, '\n', job->end - p);
+    lines++;
+    if (!nl) break;
+    p = nl + 1;
+  }
+  job->lines = lines;
+  return NULL;
+}
+
+static void* parse_slice(void* arg) {
+  text_job* job = (text_job*)arg;
+  long k = 0, bad = 0;
+  const char* p = job->begin;
+  while (p < job->end) {
+    point2d q;
+    int r = parse_line(p, job->end, &q, &p);
+    if (r > 0) job->out[k++] = q;
+    else if (r < 0) bad++;
+  }
+  job->points = k;
+  job->bad = bad;
+  return NULL;
+}
+
+
+static void* hull_slice(void* arg) {
+  text_job* job = (text_job*)arg;
+  long k = 0, bad = 0;
+  vector<point2d>& buf = job->hull;
+  buf.clear();
+  buf.reserve(job->chunk + 64);
+  //the hull so far is at the front of buf, the chunk after it. a point
+  //in the hull so far (a copy in cur) cannot be a vertex of the final
+  //hull, and is dropped as soon as it is parsed: on most inputs that
+  //is nearly all of them after the first chunk
+  size_t hsize = 0;
+  vector<point2d> cur;
+  const char* p = job->begin;
+  while (p < job->end) {
+    point2d q;
+    int r = parse_line(p, job->end, &q, &p);
+    if (r > 0) {
+      k++;
+      if (cur.size() >= 3 && hull_contains(cur, q)) continue;
+      buf.push_back(q);
+      if (buf.size() >= hsize + job->chunk) {
+        graham_scan_inplace(buf);
+        hsize = buf.size();
+        cur = buf;
+      }
+    } else if (r < 0) {
+      bad++;
+    }
+  }
+  if (buf.size() > hsize) graham_scan_inplace(buf);
+  job->points = k;
+  job->bad = bad;
+  return NULL;
+}
+
+/* the jobs for the slices of m */
+static void make_jobs(const text_map* m, int nthreads, vector<text_job>& jobs) {
+  if (nthreads < 1) nthreads = 1;
+  //no point in slices of less than a page or so
+  long most = m->len / 4096 + 1;
+  if (nthreads > most) nthreads = most;
+  vector<size_t> cut;
+  slice_bounds(m->data, m->len, nthreads, cut);
+  jobs.resize(nthreads);
+  for (int t = 0; t < nthreads; t++) {
+    jobs[t].begin = m->data + cut[t];
+    jobs[t].end = m->data + cut[t+1];
+    jobs[t].lines = jobs[t].points = jobs[t].bad = 0;
+    jobs[t].out = NULL;
+    jobs[t].chunk = 0;
+  }
+}
+
+
+/* ****************************** */
+long read_points_text(const char* path, vector<point2d>& pts, int nthreads,
+                      text_parse_stats* stats) {
+  double t0 = now_seconds();
+  pts.clear();
+  text_map m;
+  if (!map_text(path, &m)) return -1;
+
+  vector<text_job> jobs;
+  make_jobs(&m, nthreads, jobs);
+  run_jobs(count_lines, jobs);
+
+  //every slice parses into its own part of pts, then the parts are
+  //moved down over the lines that were not points
+  long total = 0;
+  for (size_t t = 0; t < jobs.size(); t++) total += jobs[t].lines;
+  pts.resize(total);
+  long off = 0;
+  for (size_t t = 0; t < jobs.size(); t++) {
+    jobs[t].out = pts.data() + off;
+    off += jobs[t].lines;
+  }
+  run_jobs(parse_slice, jobs);
+
+  long k = 0, bad = 0;
+  for (size_t t = 0; t < jobs.size(); t++) {
+    if (jobs[t].out != pts.data() + k) {
+      memmove(pts.data() + k, jobs[t].out, jobs[t].points * sizeof(point2d));
+    }
+    k += jobs[t].points;
+    bad += jobs[t].bad;
+  }
+  pts.resize(k);
+  unmap_text(&m);
+
+  if (stats) {
+    stats->bytes = m.len;
+    stats->points = k;
+    stats->bad_lines = bad;
+    stats->seconds = now_seconds() - t0;
+  }
+  return k;
+}
+
+
+long hull_of_text_file(const char* path, vector<point2d>& hull, int nthreads, int chunk,
+                       text_parse_stats* stats) {
+  double t0 = now_seconds();
+  hull.clear();
+  text_map m;
+  if (!map_text(path, &m)) return -1;
+  assert(chunk > 0);
+
+  vector<text_job> jobs;
+  make_jobs(&m, nthreads, jobs);
+  for (size_t t = 0; t < jobs.size(); t++) jobs[t].chunk = chunk;
+  run_jobs(hull_slice, jobs);
+
+  long k = 0, bad = 0;
+  for (size_t t = 0; t < jobs.size(); t++) {
+    hull.insert(hull.end(), jobs[t].hull.begin(), jobs[t].hull.end());
+    k += jobs[t].points;
+    bad += jobs[t].bad;
+  }
+  graham_scan_inplace(hull);
+  unmap_text(&m);
+
+  if (stats) {
+    stats->bytes = m.len;
+    stats->points = k;
+    stats->bad_lines = bad;
+    stats->seconds = now_seconds() - t0;
+  }
+  return k;
+}
+
+
+/* ****************************** */
+int write_points_text(const char* path, const vector<point2d>& pts) {
+  FILE* f = fopen(path, "w");
+  if (!f) {
+    perror(path);
+    return 0;
+  }
+  //formatted by hand into a large buffer: fprintf would be the bottleneck
+  vector<char> buf(1 << 20);
+  size_t used = 0;
+  for (size_t i = 0; i < pts.size(); i++) {
+    if (buf.size() - used < 32) {
+      fwrite(buf.data(), 1, used, f);
+      used = 0;
+    }
+    char* p = buf.data() + used;
+    char* end = buf.data() + buf.size();
+    p = to_chars(p, end, pts[i].x).ptr;
+    *p++ = ' ';
+    p = to_chars(p, end, pts[i].y).ptr;
+    *p++ = '\n';
+    used = p - buf.data();
+  }
+  fwrite(buf.data(), 1, used, f);
+  int ok = !ferror(f);
+  if (fclose(f) != 0) ok = 0;
+  if (!ok) perror(path);
+  return ok;
+}
@@ -0,0 +1,62 @@
+#ifndef __pointtext_h
+#define __pointtext_h
+
+#include "geom.h"
+
+#include <stddef.h>
+
+#include <vector>
+
+using namespace std;
+
+
+/*
+  reading points from text files, in parallel.
+
+  the format is one point per line: two integers separated by spaces,
+  tabs, a comma or a semicolon (so "12 34", "12,34" and "12, 34" all
+  work). empty lines and lines starting with '#' are skipped, anything
+  after the second number is ignored, and \r\n line ends are fine. a
+  line that does not start with two integers is counted as bad and
+  skipped.
+
+  the file is mmap()ed and cut into nthreads slices at line
+  boundaries, and every thread parses its slice with std::from_chars,
+  which does no locale lookups and no copying. there is no stdio in
+  the way, so the parse runs at memory speed per core.
+*/
+
+typedef struct _text_parse_stats {
+  size_t bytes;     //size of the file
+  long points;      //points read
+  long bad_lines;   //lines that are not a point (not blank or comments)
+  double seconds;   //wall time of the parse
+} text_parse_stats;
+
+
+/*
+  reads the points of the text file path into pts, with nthreads
+  threads, and returns their number (or -1 if the file cannot be
+  read). newlines are counted first, so every thread parses straight
+  into its own part of pts, and pts is allocated once
+*/
+long read_points_text(const char* path, vector<point2d>& pts, int nthreads,
+                      text_parse_stats* stats = NULL);
+
+/*
+  the hull of the points of the text file, without storing them: every
+  thread parses its slice, drops the points that fall inside its hull
+  so far as soon as they are parsed, and replaces every chunk points
+  that get through, together with the hull so far, by their hull. so
+  the parse, the filter and the hull overlap, and memory is
+  O(nthreads * chunk). the hulls of the slices are merged at the end.
+  returns the number of points read, or -1 if the file cannot be read
+*/
+long hull_of_text_file(const char* path, vector<point2d>& hull, int nthreads, int chunk,
+                       text_parse_stats* stats = NULL);
+
+/* writes pts to path as text, one "x y" per line; returns 1 on success */
+int write_points_text(const char* path, const vector<point2d>& pts);
+
+
+#endif
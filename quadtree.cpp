@@ -0,0 +1,131 @@
+#include "quadtree.h"
+
+#include <math.h>
+
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+
+/* ****************************** */
+/* sets the bounding box of node i from its points */
+static void set_box(point_quadtree* q, int i) {
+  quad_node* nd = &q->nodes[i];
+  const point2d* p = q->pts.data();
+  nd->xmin = nd->xmax = p[nd->begin].x;
+  nd->ymin = nd->ymax = p[nd->begin].y;
+  for (long j = nd->begin + 1; j < nd->end; j++) {
+    nd->xmin = min(nd->xmin, p[j].x);
+    nd->xmax = max(nd->xmax, p[j].x);
+    nd->ymin = min(nd->ymin, p[j].y);
+    nd->ymax = max(nd->ymax, p[j].y);
+  }
+}
+
+/* the middle of [lo, hi], without overflow */
+static inline int middle(int lo, int hi) {
+  return (int)(lo + ((long long)hi - lo) / 2);
+}
+
+/*
+  splits node i, whose points are set, and its children, recursively.
+  the sums of the coordinates of its points go in *sx, *sy, for the
+  centroids. q->nodes grows, so the node is only ever used by index
+*/
+static void build_node(point_quadtree* q, int i, int depth, long long* sx, long long* sy) {
+  q->depth = max(q->depth, depth);
+  set_box(q, i);
+  quad_node nd = q->nodes[i];
+  point2d* p = q->pts.data();
+  long long x = 0, y = 0;
+
+  if (nd.end - nd.begin <= QUADTREE_LEAF || (nd.xmin == nd.xmax && nd.ymin == nd.ymax)) {
+    for (long j = nd.begin; j < nd.end; j++) {
+      x += p[j].x;
+      y += p[j].y;
+    }
+  } else {
+    //the points on the middle go low. the box shrinks in x or in y (or
+    //both) at every level, since xmin stays low and xmax goes high
+    int mx = middle(nd.xmin, nd.xmax), my = middle(nd.ymin, nd.ymax);
+    point2d* b = p + nd.begin;
+    point2d* e = p + nd.end;
+    point2d* m = partition(b, e, [mx](const point2d& a) { return a.x <= mx; });
+    point2d* ml = partition(b, m, [my](const point2d& a) { return a.y <= my; });
+    point2d* mh = partition(m, e, [my](const point2d& a) { return a.y <= my; });
+    point2d* cut[5] = {b, ml, m, mh, e};
+
+    int first = q->nodes.size(), nchildren = 0;
+    for (int k = 0; k < 4; k++) {
+      if (cut[k] == cut[k+1]) continue;
+      quad_node c;
+      c.begin = cut[k] - p;
+      c.end = cut[k+1] - p;
+      c.child = -1;
+      c.nchildren = 0;
+      q->nodes.push_back(c);
+      nchildren++;
+    }
+    q->nodes[i].child = first;
+    q->nodes[i].nchildren = nchildren;
+    for (int c = first; c < first + nchildren; c++) {
+      long long cx, cy;
+      build_node(q, c, depth + 1, &cx, &cy);
+      x += cx;
+      y += cy;
+    }
+  }
+
+  double n = nd.end - nd.begin;
+  q->nodes[i].rep.x = lround(x / n);
+  q->nodes[i].rep.y = lround(y / n);
+  *sx = x;
+  *sy = y;
+}
+
+
+/* ****************************** */
+void quadtree_build(point_quadtree* q, const vector<point2d>& pts) {
+  q->pts = pts;
+  q->nodes.clear();
+  q->depth = 0;
+  if (pts.empty()) return;
+  //about 4/3 of a node per leaf
+  q->nodes.reserve(pts.size() / QUADTREE_LEAF * 3 / 2 + 16);
+  quad_node root;
+  root.begin = 0;
+  root.end = pts.size();
+  root.child = -1;
+  root.nchildren = 0;
+  q->nodes.push_back(root);
+  long long sx, sy;
+  build_node(q, 0, 0, &sx, &sy);
+}
+
+
+/* ****************************** */
+long quadtree_query(const point_quadtree* q, double x0, double y0, double x1, double y1,
+                    double pixel, vector<point2d>& out) {
+  out.clear();
+  if (q->nodes.empty()) return 0;
+  long reps = 0;
+  vector<int> stack;
+  stack.reserve(4 * (q->depth + 1));
+  stack.push_back(0);
+  while (!stack.empty()) {
+    const quad_node& nd = q->nodes[stack.back()];
+    stack.pop_back();
+    if (nd.xmax < x0 || nd.xmin > x1 || nd.ymax < y0 || nd.ymin > y1) continue;
+    if (nd.xmax - nd.xmin < pixel && nd.ymax - nd.ymin < pixel) {
+      out.push_back(nd.rep);
+      reps++;
+    } else if (nd.child < 0) {
+      //partly out of view, maybe: clipped when drawn
+      out.insert(out.end(), q->pts.begin() + nd.begin, q->pts.begin() + nd.end);
+    } else {
+      for (int c = nd.child; c < nd.child + nd.nchildren; c++) stack.push_back(c);
+    }
+  }
+  return reps;
+}
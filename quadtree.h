@@ -0,0 +1,55 @@
+#ifndef __quadtree_h
+#define __quadtree_h
+
+#include "geom.h"
+
+#include <vector>
+
+using namespace std;
+
+
+/*
+  a quadtree over a set of points, to draw them at any zoom without
+  looking at all of them: the nodes out of the view are skipped whole,
+  and a node that is smaller than a pixel is drawn as one point, so a
+  frame costs about the number of pixels in view, not the number of
+  points.
+
+  built once. the points are copied, and the copy is partitioned in
+  place, around the middle of the bounding box in x and then in y, like
+  a quicksort, so the points of every node are contiguous and nothing
+  else is allocated per point. a node has the bounding box of its points
+  (not of its cell), which culls better on clustered points, and stops
+  being split at QUADTREE_LEAF points or when all its points are equal.
+*/
+
+#define QUADTREE_LEAF 64
+
+typedef struct _quad_node {
+  int xmin, ymin, xmax, ymax;  //the bounding box of its points
+  long begin, end;             //its points are pts[begin, end)
+  int child, nchildren;        //its children are consecutive; child is -1 for a leaf
+  point2d rep;                 //the centroid of its points, drawn for it when it is small
+} quad_node;
+
+typedef struct _point_quadtree {
+  vector<point2d> pts;     //the points, in the order of the leaves
+  vector<quad_node> nodes; //nodes[0] is the root
+  int depth;
+} point_quadtree;
+
+
+/* builds the quadtree of pts */
+void quadtree_build(point_quadtree* q, const vector<point2d>& pts);
+
+/*
+  the points to draw for the view [x0, x1] x [y0, y1], in which a pixel
+  is pixel units wide: the points of the leaves in view, and the
+  representative of every node in view that is smaller than a pixel, in
+  out. returns how many of them are representatives
+*/
+long quadtree_query(const point_quadtree* q, double x0, double y0, double x1, double y1,
+                    double pixel, vector<point2d>& out);
+
+
+#endif
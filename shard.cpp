@@ -0,0 +1,241 @@
+/* shard.cpp
+
+   Multi-process sharded hull driver.
+
+   The input is a binary file of point2d records (two native ints per
+   point). The parent forks P workers; worker i mmaps only its own slice
+   of the file (privately, so the in-place scan can overwrite it without
+   touching the file), computes the hull of the slice with
+   graham_scan_inplace() and writes it into its region of a shared
+   memory result area. The parent waits for all of them and computes
+   the hull of the union of the sub-hulls.
+
+   Everything is local: the workers are forked processes and the result
+   area is an anonymous shared mapping.
+
+   usage: hullshard [-p nprocs] [-o hull.bin] points.bin
+          hullshard -g npoints points.bin     (writes random points)
+*/
+
+#include "geom.h"
+#include "rtimer.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <limits.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <vector>
+#include <algorithm>
+using namespace std;
+
+
+/* the result of one worker, followed in the result area by room for
+   as many hull points as its slice has points */
+typedef struct _shard_result {
+  long n;       //number of points in the slice
+  long h;       //number of points on its hull
+  int done;     //set by the worker when the hull is written
+  double usec;  //time the worker spent
+} shard_result;
+
+
+/* ****************************** */
+/* writes n random points in [0, 2^30)^2 to path, the range in which
+   signed_area2D() is exact */
+int write_random_points(const char* path, long n) {
+  FILE* f = fopen(path, "wb");
+  if (!f) {
+    perror(path);
+    return 0;
+  }
+  point2d p;
+  for (long i = 0; i < n; i++) {
+    p.x = random() % (1 << 30);
+    p.y = random() % (1 << 30);
+    fwrite(&p, sizeof(point2d), 1, f);
+  }
+  fclose(f);
+  return 1;
+}
+
+
+/* ****************************** */
+/* the part of the result area that belongs to worker i; the index of
+   the first point of its slice is stored in *first */
+static shard_result* shard_area(char* area, long n, int nprocs, int i, long* first) {
+  *first = i * (n / nprocs) + min((long)i, n % nprocs);
+  return (shard_result*)(area + i * sizeof(shard_result) + *first * sizeof(point2d));
+}
+
+
+/* ****************************** */
+/* runs in worker i: hull of points [first, first + count) of the file.
+   count is at most INT_MAX (main() picks enough workers for that) */
+void run_worker(int fd, long first, long count, shard_result* res) {
+  Rtimer rt;
+  rt_start(rt);
+
+  res->n = count;
+  res->h = 0;
+  if (count > 0) {
+    //mmap needs a page-aligned offset
+    long page = sysconf(_SC_PAGESIZE);
+    off_t start = first * sizeof(point2d);
+    off_t aligned = start - start % page;
+    size_t len = (start - aligned) + count * sizeof(point2d);
+    char* map = (char*)mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, aligned);
+    if (map == MAP_FAILED) {
+      perror("worker mmap");
+      exit(1);
+    }
+    point2d* pts = (point2d*)(map + (start - aligned));
+
+    int h = graham_scan_inplace(pts, count);
+    memcpy((char*)res + sizeof(shard_result), pts, h * sizeof(point2d));
+    res->h = h;
+    munmap(map, len);
+  }
+
+  rt_stop(rt);
+  res->usec = rt_w_useconds(rt);
+  res->done = 1;
+}
+
+
+/* ****************************** */
+int main(int argc, char** argv) {
+
+  int nprocs = sysconf(_SC_NPROCESSORS_ONLN);
+  long generate = 0;
+  const char* out_path = NULL;
+
+  int c;
+  while ((c = getopt(argc, argv, "p:o:g:")) != -1) {
+    switch (c) {
+    case 'p': nprocs = atoi(optarg); break;
+    case 'o': out_path = optarg; break;
+    case 'g': generate = atol(optarg); break;
+    default:
+      printf("usage: %s [-p nprocs] [-o hull.bin] points.bin\n", argv[0]);
+      printf("       %s -g npoints points.bin\n", argv[0]);
+      exit(1);
+    }
+  }
+  if (optind != argc - 1) {
+    printf("usage: %s [-p nprocs] [-o hull.bin] points.bin\n", argv[0]);
+    exit(1);
+  }
+  const char* path = argv[optind];
+
+  if (generate > 0) {
+    return write_random_points(path, generate) ? 0 : 1;
+  }
+  assert(nprocs > 0);
+
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    perror(path);
+    exit(1);
+  }
+  struct stat st;
+  if (fstat(fd, &st) < 0) {
+    perror(path);
+    close(fd);
+    exit(1);
+  }
+  long n = st.st_size / sizeof(point2d);
+  //graham_scan_inplace() takes an int count: use enough workers that
+  //no slice is longer than that
+  long min_procs = (n + INT_MAX - 1) / INT_MAX;
+  if (nprocs < min_procs) {
+    fprintf(stderr, "hullshard: %ld points need %ld workers, using that many\n", n, min_procs);
+    nprocs = min_procs;
+  }
+  printf("hullshard: %ld points, %d workers\n", n, nprocs);
+
+  Rtimer rt_total;
+  rt_start(rt_total);
+
+  //the result area: a header and room for a full slice per worker. it
+  //is anonymous memory, so only the pages the workers write are used
+  size_t area_len = nprocs * sizeof(shard_result) + n * sizeof(point2d);
+  char* area = (char*)mmap(NULL, area_len, PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (area == MAP_FAILED) {
+    perror("mmap result area");
+    exit(1);
+  }
+
+  vector<pid_t> pids;
+  for (int i = 0; i < nprocs; i++) {
+    long first;
+    shard_result* res = shard_area(area, n, nprocs, i, &first);
+    long count = n / nprocs + (i < n % nprocs);
+    pid_t pid = fork();
+    if (pid < 0) {
+      perror("fork");
+      exit(1);
+    }
+    if (pid == 0) {
+      run_worker(fd, first, count, res);
+      _exit(0);
+    }
+    pids.push_back(pid);
+  }
+
+  int failed = 0;
+  for (int i = 0; i < (int)pids.size(); i++) {
+    int status;
+    waitpid(pids[i], &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      fprintf(stderr, "hullshard: worker %d failed\n", i);
+      failed = 1;
+    }
+  }
+  if (failed) exit(1);
+
+  //merge: the hull of the union of the sub-hulls
+  Rtimer rt_merge;
+  rt_start(rt_merge);
+  vector<point2d> hull;
+  for (int i = 0; i < nprocs; i++) {
+    long first;
+    shard_result* res = shard_area(area, n, nprocs, i, &first);
+    assert(res->done);
+    point2d* sub = (point2d*)((char*)res + sizeof(shard_result));
+    hull.insert(hull.end(), sub, sub + res->h);
+    printf("  worker %2d: %ld points, hull %ld, %.3f s\n", i, res->n, res->h, res->usec / 1e6);
+  }
+  graham_scan_inplace(hull);
+  rt_stop(rt_merge);
+  rt_stop(rt_total);
+
+  char buf[1024];
+  rt_sprint(buf, rt_merge);
+  printf("merge time: %s\n", buf);
+  rt_sprint(buf, rt_total);
+  printf("total time: %s\n", buf);
+  printf("hull: %lu points\n", hull.size());
+
+  if (out_path) {
+    FILE* f = fopen(out_path, "wb");
+    if (!f) {
+      perror(out_path);
+      exit(1);
+    }
+    fwrite(hull.data(), sizeof(point2d), hull.size(), f);
+    fclose(f);
+  }
+
+  munmap(area, area_len);
+  close(fd);
+  return 0;
+}
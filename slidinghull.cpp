@@ -0,0 +1,238 @@
+#include "slidinghull.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vector>
+#include <set>
+#include <algorithm>
+
+using namespace std;
+
+typedef set<point2d, point2d_xless>::iterator chain_iter;
+
+
+/* **************************************** */
+static void chain_init(hull_chain* c, int logging) {
+  c->pts.clear();
+  c->log.clear();
+  c->removed.clear();
+  c->logging = logging;
+}
+
+/* removes the point at it from the chain, remembering it if logging */
+static void chain_erase(hull_chain* c, chain_iter it, int* nremoved) {
+  if (c->logging) c->removed.push_back(*it);
+  (*nremoved)++;
+  c->pts.erase(it);
+}
+
+
+/* **************************************** */
+/*
+  inserts p into the upper hull c. the chain goes left to right and
+  turns right (clockwise) at every vertex; points below or on it, and
+  points that stop being strictly convex, are not kept.
+*/
+static void chain_insert(hull_chain* c, point2d p) {
+  chain_undo rec;
+  rec.p = p;
+  rec.inserted = 0;
+  rec.nremoved = 0;
+
+  chain_iter next = c->pts.lower_bound(p);
+  //only the highest point of every x is kept
+  if (next != c->pts.end() && next->x == p.x) {
+    //next->y >= p.y since next is not less than p
+    if (c->logging) c->log.push_back(rec);
+    return;
+  }
+  if (next != c->pts.begin()) {
+    chain_iter prev = next;
+    --prev;
+    if (prev->x == p.x) {
+      //a lower point with the same x: p replaces it
+      chain_erase(c, prev, &rec.nremoved);
+    } else if (next != c->pts.end() && !left_strictly(*prev, *next, p)) {
+      //p is below or on the chain
+      if (c->logging) c->log.push_back(rec);
+      return;
+    }
+  }
+
+  chain_iter it = c->pts.insert(p).first;
+  rec.inserted = 1;
+
+  //remove the points right of p that are no longer convex
+  while (true) {
+    chain_iter b = it;
+    ++b;
+    if (b == c->pts.end()) break;
+    chain_iter b2 = b;
+    ++b2;
+    if (b2 == c->pts.end() || signed_area2D(p, *b, *b2) < 0) break;
+    chain_erase(c, b, &rec.nremoved);
+  }
+  //and the points left of p
+  while (it != c->pts.begin()) {
+    chain_iter b = it;
+    --b;
+    if (b == c->pts.begin()) break;
+    chain_iter b2 = b;
+    --b2;
+    if (signed_area2D(*b2, *b, p) < 0) break;
+    chain_erase(c, b, &rec.nremoved);
+  }
+
+  if (c->logging) c->log.push_back(rec);
+}
+
+
+/* **************************************** */
+/* undoes the last logged insertion into c */
+static void chain_undo_last(hull_chain* c) {
+  assert(c->logging && c->log.size() > 0);
+  chain_undo rec = c->log.back();
+  c->log.pop_back();
+  if (rec.inserted) c->pts.erase(rec.p);
+  for (int i = 0; i < rec.nremoved; i++) {
+    c->pts.insert(c->removed.back());
+    c->removed.pop_back();
+  }
+}
+
+
+/* **************************************** */
+static point2d reflect(point2d p) {
+  point2d q;
+  q.x = p.x;
+  q.y = -p.y;
+  return q;
+}
+
+/* inserts p into the pair of chains up, lo */
+static void insert_point(hull_chain* up, hull_chain* lo, point2d p) {
+  chain_insert(up, p);
+  chain_insert(lo, reflect(p));
+}
+
+
+/* **************************************** */
+void sliding_hull_init(sliding_hull* sh, int max_points, double max_age) {
+  sh->max_points = max_points;
+  sh->max_age = max_age;
+  sh->front.clear();
+  sh->back.clear();
+  chain_init(&sh->front_up, 1);
+  chain_init(&sh->front_lo, 1);
+  chain_init(&sh->back_up, 0);
+  chain_init(&sh->back_lo, 0);
+}
+
+
+/* **************************************** */
+int sliding_hull_size(const sliding_hull* sh) {
+  return sh->front.size() + sh->back.size();
+}
+
+
+/* **************************************** */
+void sliding_hull_push(sliding_hull* sh, point2d p, double t) {
+  timed_point tp;
+  tp.p = p;
+  tp.t = t;
+  sh->back.push_back(tp);
+  insert_point(&sh->back_up, &sh->back_lo, p);
+
+  if (sh->max_points > 0) {
+    while (sliding_hull_size(sh) > sh->max_points) {
+      sliding_hull_pop(sh);
+    }
+  }
+  sliding_hull_expire(sh, t);
+}
+
+
+/* **************************************** */
+void sliding_hull_pop(sliding_hull* sh) {
+  if (sh->front.empty()) {
+    if (sh->back.empty()) return;
+    //move the back stack to the front, newest first, so that the oldest
+    //point ends up on top and is the last insertion in the undo log
+    for (int i = sh->back.size() - 1; i >= 0; i--) {
+      sh->front.push_back(sh->back[i]);
+      insert_point(&sh->front_up, &sh->front_lo, sh->back[i].p);
+    }
+    sh->back.clear();
+    chain_init(&sh->back_up, 0);
+    chain_init(&sh->back_lo, 0);
+  }
+  sh->front.pop_back();
+  chain_undo_last(&sh->front_up);
+  chain_undo_last(&sh->front_lo);
+}
+
+
+/* **************************************** */
+void sliding_hull_expire(sliding_hull* sh, double t) {
+  if (sh->max_age <= 0) return;
+  while (sliding_hull_size(sh) > 0) {
+    double oldest = sh->front.empty() ? sh->back[0].t : sh->front.back().t;
+    if (t - oldest <= sh->max_age) break;
+    sliding_hull_pop(sh);
+  }
+}
+
+
+/* **************************************** */
+/*
+  merges the two upper hulls a and b (sorted by x) and computes the upper
+  hull of their union with a monotone chain scan
+*/
+static void merge_chains(const hull_chain* a, const hull_chain* b, vector<point2d>& chain) {
+  vector<point2d> merged(a->pts.size() + b->pts.size());
+  merge(a->pts.begin(), a->pts.end(), b->pts.begin(), b->pts.end(),
+        merged.begin(), point2d_xless());
+
+  chain.clear();
+  for (int i = 0; i < (int)merged.size(); i++) {
+    point2d p = merged[i];
+    //same x: the later point is higher and replaces the previous one
+    if (chain.size() > 0 && chain.back().x == p.x) chain.pop_back();
+    while (chain.size() >= 2 && signed_area2D(chain[chain.size()-2], chain.back(), p) >= 0) {
+      chain.pop_back();
+    }
+    chain.push_back(p);
+  }
+}
+
+
+/* **************************************** */
+void sliding_hull_get(const sliding_hull* sh, vector<point2d>& hull) {
+  vector<point2d> up, lo;
+  merge_chains(&sh->front_up, &sh->back_up, up);
+  merge_chains(&sh->front_lo, &sh->back_lo, lo);
+
+  //lower hull left to right, then upper hull right to left
+  vector<point2d> all;
+  for (int i = 0; i < (int)lo.size(); i++) {
+    all.push_back(reflect(lo[i]));
+  }
+  for (int i = up.size() - 1; i >= 0; i--) {
+    all.push_back(up[i]);
+  }
+
+  hull.clear();
+  for (int i = 0; i < (int)all.size(); i++) {
+    if (hull.size() > 0 && hull.back().x == all[i].x && hull.back().y == all[i].y) continue;
+    hull.push_back(all[i]);
+  }
+  while (hull.size() > 1 && hull.back().x == hull[0].x && hull.back().y == hull[0].y) {
+    hull.pop_back();
+  }
+  if (hull.size() == 0) return;
+
+  //start at the bottom point, like build_hull()
+  int bottom = find_bottom_point(hull);
+  rotate(hull.begin(), hull.begin() + bottom, hull.end());
+}
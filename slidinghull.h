@@ -0,0 +1,91 @@
+#ifndef __slidinghull_h
+#define __slidinghull_h
+
+#include "geom.h"
+
+#include <vector>
+#include <set>
+
+using namespace std;
+
+
+/*
+  hull of the last W points (or of the points that arrived in the last T
+  seconds) of a stream.
+
+  the window is a queue implemented with two stacks. the back stack
+  holds the newest points and the upper and lower hull of all of them,
+  maintained incrementally. the front stack holds the oldest points; it
+  is built by inserting the back stack newest-first into a second pair
+  of hulls that records an undo log, so that expiring the oldest point
+  is undoing the last insertion. every point is inserted and undone at
+  most once, so push and expire take O(log W) amortized time.
+  getting the hull merges the two pairs of chains in O(h).
+*/
+
+
+/* orders points by x, then by y */
+struct point2d_xless {
+  bool operator()(const point2d& a, const point2d& b) const {
+    return a.x < b.x || (a.x == b.x && a.y < b.y);
+  }
+};
+
+/* what a single insertion did to a chain, so that it can be undone */
+typedef struct _chain_undo {
+  point2d p;     //the inserted point
+  int inserted;  //0 if p was below the chain and nothing changed
+  int nremoved;  //how many points the insertion removed from the chain
+} chain_undo;
+
+/*
+  an upper hull, as a set of points ordered by x. the lower hull is
+  stored as the upper hull of the points reflected by y -> -y
+*/
+typedef struct _hull_chain {
+  set<point2d, point2d_xless> pts;
+  vector<chain_undo> log;      //one record per insertion, if logging
+  vector<point2d> removed;     //points removed by the logged insertions
+  int logging;
+} hull_chain;
+
+/* a point in the window, with its arrival time */
+typedef struct _timed_point {
+  point2d p;
+  double t;
+} timed_point;
+
+typedef struct _sliding_hull {
+  int max_points;      //W; 0 for no count limit
+  double max_age;      //T, in seconds; 0 for no time limit
+
+  vector<timed_point> front;  //oldest points, the oldest on top (at the end)
+  vector<timed_point> back;   //newest points, the newest at the end
+  hull_chain front_up, front_lo;
+  hull_chain back_up, back_lo;
+} sliding_hull;
+
+
+/* initializes an empty window keeping at most max_points points and
+   points at most max_age seconds old (0 means no limit) */
+void sliding_hull_init(sliding_hull* sh, int max_points, double max_age);
+
+/* adds point p that arrived at time t (in seconds, non-decreasing) and
+   expires the points that fall out of the window */
+void sliding_hull_push(sliding_hull* sh, point2d p, double t);
+
+/* expires the oldest point in the window; nothing happens if it is empty */
+void sliding_hull_pop(sliding_hull* sh);
+
+/* expires all points that arrived before time t - max_age */
+void sliding_hull_expire(sliding_hull* sh, double t);
+
+/* number of points in the window */
+int sliding_hull_size(const sliding_hull* sh);
+
+/* stores the hull of the window in hull, in CCW order starting at the
+   bottom point (rightmost if tied), like build_hull() */
+void sliding_hull_get(const sliding_hull* sh, vector<point2d>& hull);
+
+
+#endif
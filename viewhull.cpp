@@ -10,12 +10,21 @@
 
 #include "geom.h"
 #include "rtimer.h"
+#include "hrtimer.h"
+#include "hullcache.h"
+#include "hullarena.h"
+#include "parhull.h"
+#include "approxhull.h"
+#include "melkman.h"
+#include "kinetichull.h"
+#include "quadtree.h"
 
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
 #include <assert.h>
 #include <strings.h>
+#include <time.h>
 
 //to compile on both apple and unix platform
 #ifdef __APPLE__
@@ -76,9 +85,84 @@ vector<point2d>  hull;
 
 
 
+//hulls already computed, so that cycling through the initializers
+//does not recompute them. 'c' turns it on and off
+hull_cache cache;
+int USE_CACHE = 1;
+const size_t CACHE_BUDGET = 64 << 20;
+
+
+/* the hull engines; 'e' cycles through them, recomputing the hull of
+   the same points */
+#define ENGINE_GRAHAM    0  //graham_scan(), through the cache if it is on
+#define ENGINE_INPLACE   1  //graham_scan_inplace() on a copy of the points
+#define ENGINE_ARENA     2  //graham_scan() with its buffers from an arena
+#define ENGINE_PARALLEL  3  //parallel_hull() with NTHREADS threads
+#define ENGINE_APPROX    4  //approx_hull() with APPROX_STRIPS strips
+#define ENGINE_MELKMAN   5  //melkman_hull(), taking the points as a polyline
+int NB_ENGINES = 6;
+int ENGINE = ENGINE_GRAHAM;
+const char* engine_names[] = {"graham_scan", "graham_scan_inplace", "graham_scan (arena)",
+                              "parallel_hull", "approx_hull", "melkman_hull"};
+
+hull_arena arena;
+const int APPROX_STRIPS = 64;
+
+//thread counts for ENGINE_PARALLEL; 't' cycles through them
+int thread_choices[] = {1, 2, 4, 8};
+int NB_THREAD_CHOICES = 4;
+int NTHREADS = 2;
+
+
+/* the performance overlay, drawn over the points. 'o' turns it on and off */
+int SHOW_OVERLAY = 1;
+
+//the times of the latest recomputes of the hull, in ms, in a ring
+#define HISTORY 100
+double recompute_ms[HISTORY];
+int nrecomputes = 0;
+
+//points left by the filter of graham_scan() in the last recompute
+int filter_kept = 0;
+//what the engine of the last recompute has to say about it
+char engine_note[128] = "";
+//the time to draw the last frame, in ms
+double frame_ms = 0;
+
+
+/* kinetic mode: every point moves with its own velocity, bouncing off
+   the sides of the window, and the hull follows them with a
+   kinetic_hull, updated every frame. to compare, the hull is also
+   recomputed from scratch every frame. 'k' starts and stops it */
+int KINETIC = 0;
+kinetic_hull khull;
+double kinetic_start_ms;       //wall time of the start
+const double MAX_SPEED = 60;   //pixels per second, in x and in y
+//the full recompute of every frame, in a ring like recompute_ms (which
+//gets the kinetic updates)
+double full_ms[HISTORY];
+long frame_events = 0;         //certificate failures in the last frame
+vector<fpoint2d> kinetic_pos;  //where the points are, for the recompute
+vector<fpoint2d> kinetic_out;
+
+
 //window size for the graphics window
 const int WINDOWSIZE = 500; 
 
+
+/* zoom and pan: the window shows [view_x, view_x + WINDOWSIZE/view_zoom]
+   x [view_y, ...]. the mouse wheel (or '+' and '-') zooms around the
+   cursor, dragging pans, '0' goes back to the whole window */
+double view_x = 0, view_y = 0, view_zoom = 1;
+const double MAX_ZOOM = 4096;
+int dragging = 0, drag_x, drag_y;
+
+//the points, indexed when they change, so a frame draws only what is
+//in view, and a cell smaller than a pixel as one point
+point_quadtree quad;
+vector<point2d> visible;   //what the last frame drew
+long visible_reps = 0;     //how many of them stand for a cell
+
 /* currently there are 4 different ways to initialize points.  The
    user can cycle through them by pressing 'i'. Check out the display()
    function.
@@ -110,6 +194,27 @@ void draw_points(vector<point2d> pts);
 
 void display(void);
 void keypress(unsigned char key, int x, int y);
+void mouse(int button, int state, int x, int y);
+void motion(int x, int y);
+void zoom_at(int px, int py, double f);
+
+/* builds the quadtree of the points; called whenever they change */
+void index_points();
+
+/* draws the points in view, through the quadtree */
+void draw_visible();
+
+/* recomputes the hull of the points with the current engine */
+void compute_hull();
+
+/* draws n, h, the phase times and the history of recompute times */
+void draw_overlay();
+
+/* kinetic mode: starts the points moving, moves them and updates the
+   hull (the idle function), and stops them */
+void kinetic_start();
+void kinetic_step();
+void kinetic_stop();
 
 // initializer function
 void initialize_points_circle(vector<point2d>& pts, int n); 
@@ -536,6 +641,271 @@ void print_vector(const char* label, vector<point2d> points) {
 
 
 
+/* ****************************** */
+double now_ms() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e3 + t.tv_nsec * 1e-6;
+}
+
+
+/* ****************************** */
+/* recomputes the hull of the points with the current engine. the time
+   goes in the history of the overlay, and the phases in the hrtimer
+   tree, which is reset first */
+void compute_hull() {
+
+  hrt_reset();
+  engine_note[0] = '\0';
+  double t0 = now_ms();
+  switch (ENGINE) {
+  case ENGINE_GRAHAM:
+    if (USE_CACHE) {
+      graham_scan_cached(&cache, points, hull);
+    } else {
+      graham_scan(points, hull);
+    }
+    break;
+  case ENGINE_INPLACE:
+    hull = points;
+    graham_scan_inplace(hull);
+    break;
+  case ENGINE_ARENA:
+    hull_arena_reset(&arena);
+    graham_scan(points, hull, &arena);
+    break;
+  case ENGINE_PARALLEL:
+    parallel_hull(points, hull, NTHREADS);
+    break;
+  case ENGINE_APPROX: {
+    double bound = approx_hull(points, hull, APPROX_STRIPS);
+    snprintf(engine_note, sizeof(engine_note), "%d strips, within %.1f", APPROX_STRIPS, bound);
+    break;
+  }
+  case ENGINE_MELKMAN:
+    if (!melkman_hull(points, hull)) {
+      snprintf(engine_note, sizeof(engine_note), "not a simple polyline, fell back");
+    }
+    break;
+  }
+  double ms = now_ms() - t0;
+
+  recompute_ms[nrecomputes % HISTORY] = ms;
+  nrecomputes++;
+  //not timed: only for the overlay
+  filter_kept = delete_middle_points(points).size();
+  if (ENGINE == ENGINE_PARALLEL) {
+    snprintf(engine_note, sizeof(engine_note), "%d threads", NTHREADS);
+  }
+  if (ENGINE == ENGINE_GRAHAM && USE_CACHE) hull_cache_print_stats(stdout, &cache);
+
+  printf("%s: n=%d h=%d %.3f ms %s\n", engine_names[ENGINE], (int)points.size(),
+         (int)hull.size(), ms, engine_note);
+}
+
+
+/* ****************************** */
+/* draws s with its lower left corner at (x, y), in window coordinates */
+void draw_text(int x, int y, const char* s) {
+  glRasterPos2i(x, y);
+  for (; *s; s++) glutBitmapCharacter(GLUT_BITMAP_8_BY_13, *s);
+}
+
+/* the lines for the nodes of the hrtimer tree under n, indented by depth */
+void draw_phases(const hrt_node* n, int depth, int x, int* y, int* lines) {
+  for (size_t i = 0; i < n->children.size() && *lines < 10; i++) {
+    const hrt_node* c = n->children[i];
+    char buf[128], peak[32];
+    snprintf(buf, sizeof(buf), "%*s%s %.3f ms  %lld allocs  peak %s", 2 * depth, "", c->name.c_str(),
+             c->tw_nsec * 1e-6, c->allocs, hrt_sprint_bytes(peak, c->peak_bytes));
+    draw_text(x, *y, buf);
+    *y -= 13;
+    (*lines)++;
+    draw_phases(c, depth + 1, x, y, lines);
+  }
+}
+
+/* draws the overlay in the top left corner of the window, and the
+   history of the recompute times in the bottom left corner */
+void draw_overlay() {
+
+  //in window coordinates, whatever the points are drawn with
+  glMatrixMode(GL_MODELVIEW);
+  glPushMatrix();
+  glLoadIdentity();
+  glScalef(2.0/WINDOWSIZE, 2.0/WINDOWSIZE, 1.0);
+  glTranslatef(-WINDOWSIZE/2, -WINDOWSIZE/2, 0);
+
+  char buf[128];
+  int x = 5, y = WINDOWSIZE - 15;
+  glColor3fv(white);
+  snprintf(buf, sizeof(buf), "[e] %s  [t] %d threads", engine_names[ENGINE], NTHREADS);
+  draw_text(x, y, buf);
+  y -= 13;
+  snprintf(buf, sizeof(buf), "n %d  h %d  filter kept %d", (int)points.size(), (int)hull.size(), filter_kept);
+  draw_text(x, y, buf);
+  y -= 13;
+  double last = nrecomputes ? recompute_ms[(nrecomputes - 1) % HISTORY] : 0;
+  if (KINETIC) {
+    double full = nrecomputes ? full_ms[(nrecomputes - 1) % HISTORY] : 0;
+    snprintf(buf, sizeof(buf), "[k] kinetic %.3f ms (%ld events)  full %.3f ms", last, frame_events, full);
+    draw_text(x, y, buf);
+    y -= 13;
+    snprintf(buf, sizeof(buf), "frame %.2f ms  %ld inserts %ld deletes %ld rebuilds", frame_ms,
+             khull.stats.inserts, khull.stats.deletes, khull.stats.rebuilds);
+  } else {
+    snprintf(buf, sizeof(buf), "hull %.3f ms  frame %.2f ms", last, frame_ms);
+  }
+  draw_text(x, y, buf);
+  y -= 13;
+  if (engine_note[0]) {
+    draw_text(x, y, engine_note);
+    y -= 13;
+  }
+  if (!KINETIC) {
+    snprintf(buf, sizeof(buf), "zoom %gx  drew %d points (%ld cells)", view_zoom,
+             (int)visible.size(), visible_reps);
+    draw_text(x, y, buf);
+    y -= 13;
+  }
+  glColor3fv(Wheat);
+  int lines = 0;
+  draw_phases(hrt_root(), 0, x, &y, &lines);
+
+  //the history: one bar per recompute, oldest on the left, scaled to
+  //the slowest one shown. in kinetic mode, the full recomputes of the
+  //same frames are drawn behind, in gray
+  int count = min(nrecomputes, HISTORY);
+  if (count > 0) {
+    const int gx = 5, gy = 5, gw = 2 * HISTORY, gh = 60;
+    double worst = 0;
+    for (int i = 0; i < count; i++) worst = max(worst, recompute_ms[i]);
+    if (KINETIC) {
+      for (int i = 0; i < count; i++) worst = max(worst, full_ms[i]);
+    }
+    glColor3fv(gray);
+    glBegin(GL_LINE_LOOP);
+    glVertex2f(gx, gy);
+    glVertex2f(gx + gw, gy);
+    glVertex2f(gx + gw, gy + gh);
+    glVertex2f(gx, gy + gh);
+    glEnd();
+    if (KINETIC) {
+      glBegin(GL_LINES);
+      for (int i = 0; i < count; i++) {
+        double ms = full_ms[(nrecomputes - count + i) % HISTORY];
+        glVertex2f(gx + 2 * i, gy);
+        glVertex2f(gx + 2 * i, gy + gh * ms / worst);
+      }
+      glEnd();
+    }
+    glColor3fv(LimeGreen);
+    glBegin(GL_LINES);
+    for (int i = 0; i < count; i++) {
+      double ms = recompute_ms[(nrecomputes - count + i) % HISTORY];
+      double bar = worst > 0 ? gh * ms / worst : 0;
+      glVertex2f(gx + 2 * i + 1, gy);
+      glVertex2f(gx + 2 * i + 1, gy + bar);
+    }
+    glEnd();
+    glColor3fv(white);
+    snprintf(buf, sizeof(buf), "%.3f ms", worst);
+    draw_text(gx + gw + 4, gy + gh - 10, buf);
+  }
+
+  glPopMatrix();
+}
+
+
+/* ****************************** */
+/* starts the kinetic mode from where the points are, with random
+   velocities */
+void kinetic_start() {
+
+  int n = points.size();
+  kinetic_pos.resize(n);
+  vector<fpoint2d> vel(n);
+  for (int i = 0; i < n; i++) {
+    kinetic_pos[i].x = points[i].x;
+    kinetic_pos[i].y = points[i].y;
+    vel[i].x = MAX_SPEED * (2.0 * random() / RAND_MAX - 1);
+    vel[i].y = MAX_SPEED * (2.0 * random() / RAND_MAX - 1);
+  }
+  kinetic_hull_init(&khull, kinetic_pos, vel, 0);
+  kinetic_start_ms = now_ms();
+  KINETIC = 1;
+  nrecomputes = 0;
+  glutIdleFunc(kinetic_step);
+  printf("kinetic: on\n");
+}
+
+/* the idle function in kinetic mode: advances the points to the
+   current time, updates the hull, and times a full recompute of it */
+void kinetic_step() {
+
+  double t = (now_ms() - kinetic_start_ms) * 1e-3;
+  long events = khull.stats.events;
+  int n = khull.pts.size();
+
+  //the kinetic update, with the bounces: a bounce changes the velocity
+  //of a point, and so the certificates it is in
+  double t0 = now_ms();
+  kinetic_hull_advance(&khull, t);
+  for (int i = 0; i < n; i++) {
+    fpoint2d p = kinetic_hull_position(&khull, i);
+    fpoint2d v = {khull.pts[i].vx, khull.pts[i].vy};
+    int bounce = 0;
+    if ((p.x < 0 && v.x < 0) || (p.x > WINDOWSIZE && v.x > 0)) {
+      v.x = -v.x;
+      bounce = 1;
+    }
+    if ((p.y < 0 && v.y < 0) || (p.y > WINDOWSIZE && v.y > 0)) {
+      v.y = -v.y;
+      bounce = 1;
+    }
+    if (bounce) kinetic_hull_set_velocity(&khull, i, v);
+    kinetic_pos[i] = p;
+  }
+  double t1 = now_ms();
+
+  //the full recompute of the same points, without the hrtimer tree
+  //growing every frame
+  hrt_reset();
+  graham_scan(kinetic_pos, kinetic_out);
+  double t2 = now_ms();
+
+  recompute_ms[nrecomputes % HISTORY] = t1 - t0;
+  full_ms[nrecomputes % HISTORY] = t2 - t1;
+  nrecomputes++;
+  frame_events = khull.stats.events - events;
+
+  //what is drawn
+  for (int i = 0; i < n; i++) {
+    points[i].x = lround(kinetic_pos[i].x);
+    points[i].y = lround(kinetic_pos[i].y);
+  }
+  kinetic_hull_get(&khull, kinetic_out);
+  hull.resize(kinetic_out.size());
+  for (size_t i = 0; i < kinetic_out.size(); i++) {
+    hull[i].x = lround(kinetic_out[i].x);
+    hull[i].y = lround(kinetic_out[i].y);
+  }
+  glutPostRedisplay();
+}
+
+/* leaves the points where they are, with the hull of the current engine */
+void kinetic_stop() {
+
+  glutIdleFunc(NULL);
+  KINETIC = 0;
+  printf("kinetic: off, %ld events, %ld inserts, %ld deletes, %ld rebuilds\n",
+         khull.stats.events, khull.stats.inserts, khull.stats.deletes, khull.stats.rebuilds);
+  compute_hull();
+  index_points();
+  glutPostRedisplay();
+}
+
+
 /* ****************************** */
 int main(int argc, char** argv) {
 
@@ -564,16 +934,25 @@ int main(int argc, char** argv) {
   //print_vector("points:", points);
 
   //compute the convex hull 
+  hull_cache_init(&cache, CACHE_BUDGET);
+  //the phases of the hull, and their allocations too, printed and in
+  //the overlay
+  hrt_enable(1);
+  hrt_set_options(HRT_MEMORY);
   Rtimer rt1; 
   rt_start(rt1); 
-  graham_scan(points, hull); 
+  compute_hull(); 
   rt_stop(rt1); 
   print_vector("hull:", hull);
   
   //print the timing 
   char buf [1024]; 
   rt_sprint(buf,rt1);
-  printf("hull time:  %s\n\n", buf);
+  printf("hull time:  %s\n", buf);
+  //the time of every phase of the hull computation
+  hrt_print_tree(stdout);
+  printf("\n");
+  index_points();
   fflush(stdout); 
 
  
@@ -588,6 +967,8 @@ int main(int argc, char** argv) {
   /* register callback functions */
   glutDisplayFunc(display); 
   glutKeyboardFunc(keypress);
+  glutMouseFunc(mouse);
+  glutMotionFunc(motion);
 
   /* init GL */
   /* set background color black*/
@@ -608,6 +989,7 @@ int main(int argc, char** argv) {
  */
 void display(void) {
 
+  double t0 = now_ms();
   glClear(GL_COLOR_BUFFER_BIT);
   //clear all modeling transformations
   glMatrixMode(GL_MODELVIEW); 
@@ -631,12 +1013,24 @@ void display(void) {
   glScalef(2.0/WINDOWSIZE, 2.0/WINDOWSIZE, 1.0);  
   //first translate the points to [-WINDOWSIZE/2, WINDOWSIZE/2]
   glTranslatef(-WINDOWSIZE/2, -WINDOWSIZE/2, 0); 
+  //and before that, the view to [0, WINDOWSIZE]
+  glScalef(view_zoom, view_zoom, 1.0);
+  glTranslatef(-view_x, -view_y, 0);
  
-  draw_points(points);
+  //moving points are not indexed: they would need a new index every frame
+  if (KINETIC) draw_points(points);
+  else draw_visible();
   draw_hull(hull); 
+  if (SHOW_OVERLAY) draw_overlay();
 
   /* execute the drawing commands */
   glFlush();
+  if (SHOW_OVERLAY) {
+    //wait for the drawing to finish, so the frame time includes it;
+    //the overlay shows it on the next frame
+    glFinish();
+    frame_ms = now_ms() - t0;
+  }
 }
 
 
@@ -670,6 +1064,34 @@ void draw_points(vector<point2d> points){
 
 
 
+/* ****************************** */
+void index_points() {
+
+  double t0 = now_ms();
+  quadtree_build(&quad, points);
+  printf("quadtree: %d points, %d nodes, depth %d, %.1f ms\n", (int)points.size(),
+         (int)quad.nodes.size(), quad.depth, now_ms() - t0);
+}
+
+
+/* draw the points in view: a point of 3x3 pixels whatever the zoom, so
+   that a cell smaller than a pixel looks like its points would */
+void draw_visible() {
+
+  double w = WINDOWSIZE / view_zoom;
+  visible_reps = quadtree_query(&quad, view_x, view_y, view_x + w, view_y + w,
+                                1 / view_zoom, visible);
+  glColor3fv(yellow);
+  glPointSize(3);
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glVertexPointer(2, GL_INT, 0, visible.data());
+  glDrawArrays(GL_POINTS, 0, visible.size());
+  glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+
+
+
 /* ****************************** */
 /* Draw the hull; the points on the hull are expected to be in
    boundary order (either ccw or cw) or else it will look
@@ -728,14 +1150,111 @@ void keypress(unsigned char key, int x, int y) {
       initialize_points_random(points, NPOINTS); 
       break; 
     } //switch 
-    //we changed the points, so we need to recompute the hull
-    graham_scan(points, hull); 
+    //we changed the points, so we need to recompute the hull (or,
+    //when they are moving, start them again)
+    if (KINETIC) {
+      kinetic_start();
+    } else {
+      compute_hull();
+      index_points();
+    }
 
     //we changed stuff, so we need to tell GL to redraw
     glutPostRedisplay();
+    break;
+
+  case 'c':
+    USE_CACHE = !USE_CACHE;
+    printf("hull cache %s\n", USE_CACHE ? "on" : "off");
+    break;
+
+  case 'e':
+    //the next engine, on the same points
+    ENGINE = (ENGINE + 1) % NB_ENGINES;
+    compute_hull();
+    glutPostRedisplay();
+    break;
+
+  case 't':
+    //the next thread count, for the parallel engine
+    for (int i = 0; i < NB_THREAD_CHOICES; i++) {
+      if (thread_choices[i] == NTHREADS) {
+        NTHREADS = thread_choices[(i + 1) % NB_THREAD_CHOICES];
+        break;
+      }
+    }
+    printf("threads: %d\n", NTHREADS);
+    if (ENGINE == ENGINE_PARALLEL) compute_hull();
+    glutPostRedisplay();
+    break;
+
+  case 'r':
+    //recompute, to see how the time varies
+    compute_hull();
+    glutPostRedisplay();
+    break;
+
+  case 'o':
+    SHOW_OVERLAY = !SHOW_OVERLAY;
+    glutPostRedisplay();
+    break;
+
+  case 'k':
+    if (KINETIC) kinetic_stop();
+    else kinetic_start();
+    break;
+
+  case '+':
+  case '=':
+    zoom_at(WINDOWSIZE / 2, WINDOWSIZE / 2, 2);
+    break;
+
+  case '-':
+    zoom_at(WINDOWSIZE / 2, WINDOWSIZE / 2, 0.5);
+    break;
+
+  case '0':
+    view_x = view_y = 0;
+    view_zoom = 1;
+    glutPostRedisplay();
+    break;
 
   } //switch (key)
 
 }//keypress
 
 
+
+/* ****************************** */
+/* zooms by factor f, keeping the point under window pixel (px, py)
+   where it is */
+void zoom_at(int px, int py, double f) {
+  double wx = view_x + px / view_zoom, wy = view_y + py / view_zoom;
+  view_zoom = min(MAX_ZOOM, max(1.0 / 16, view_zoom * f));
+  view_x = wx - px / view_zoom;
+  view_y = wy - py / view_zoom;
+  glutPostRedisplay();
+}
+
+/* the wheel zooms (it is buttons 3 and 4 in GLUT), the left button pans */
+void mouse(int button, int state, int x, int y) {
+  if (button == GLUT_LEFT_BUTTON) {
+    dragging = (state == GLUT_DOWN);
+    drag_x = x;
+    drag_y = y;
+  } else if ((button == 3 || button == 4) && state == GLUT_DOWN) {
+    //window y goes down, the view's goes up
+    zoom_at(x, WINDOWSIZE - y, button == 3 ? 1.25 : 1 / 1.25);
+  }
+}
+
+void motion(int x, int y) {
+  if (!dragging) return;
+  view_x -= (x - drag_x) / view_zoom;
+  view_y += (y - drag_y) / view_zoom;
+  drag_x = x;
+  drag_y = y;
+  glutPostRedisplay();
+}
+
+